@@ -59,6 +59,9 @@ public:
 
 	void update(bool reset);
 
+	// evaluate the angle for all states
+	void OnApply();
+
 private:
 	void UpdateAngle();
 
@@ -27,7 +27,9 @@ SOFTWARE.*/
 #include "stdafx.h"
 #include "4PointAngleTool.h"
 #include "Document.h"
+#include "MainWindow.h"
 #include <PostGL/GLModel.h>
+#include <PostLib/FEPostModel.h>
 using namespace Post;
 
 //-----------------------------------------------------------------------------
@@ -113,7 +115,7 @@ void C4PointAngleTool::Props::SetPropertyValue(int i, const QVariant& v)
 }
 
 //-----------------------------------------------------------------------------
-C4PointAngleTool::C4PointAngleTool(CMainWindow* wnd) : CBasicTool("4Point Angle", wnd)
+C4PointAngleTool::C4PointAngleTool(CMainWindow* wnd) : CBasicTool("4Point Angle", wnd, CBasicTool::HAS_APPLY_BUTTON)
 {
 	m_deco = 0;
 
@@ -171,7 +173,10 @@ void C4PointAngleTool::UpdateAngle()
 			vec3f e1 = b - a; e1.Normalize();
 			vec3f e2 = d - c; e2.Normalize();
 
-			m_angle = 180.0*acos(e1*e2)/PI;
+			double cosa = e1*e2;
+			if (cosa >  1.0) cosa =  1.0;
+			if (cosa < -1.0) cosa = -1.0;
+			m_angle = 180.0*acos(cosa)/PI;
 
 			if (m_deco)
 			{
@@ -224,3 +229,39 @@ void C4PointAngleTool::update(bool breset)
 	}
 	else UpdateAngle();
 }
+
+//-----------------------------------------------------------------------------
+// Shows the angle as a function of time. The positions of the nodes for all states
+// are extracted in a single pass.
+void C4PointAngleTool::OnApply()
+{
+	CDocument* doc = GetActiveDocument();
+	if ((doc == nullptr) || (doc->IsValid() == false)) return;
+
+	Post::FEPostMesh& mesh = *doc->GetFEModel()->GetFEMesh(0);
+	int NN = mesh.Nodes();
+	vector<int> nodes(4);
+	for (int i = 0; i < 4; ++i)
+	{
+		if ((m_node[i] <= 0) || (m_node[i] > NN)) return;
+		nodes[i] = m_node[i] - 1;
+	}
+
+	vector<vec3f> r;
+	if (GetNodeHistory(nodes, r) == false) return;
+
+	int nstates = doc->GetFEModel()->GetStates();
+	vector<double> angle(nstates, 0.0);
+	for (int n = 0; n < nstates; ++n)
+	{
+		vec3f a = r[n*4], b = r[n*4 + 1], c = r[n*4 + 2], d = r[n*4 + 3];
+		vec3f e1 = b - a; e1.Normalize();
+		vec3f e2 = d - c; e2.Normalize();
+		double cosa = e1*e2;
+		if (cosa >  1.0) cosa =  1.0;
+		if (cosa < -1.0) cosa = -1.0;
+		angle[n] = 180.0*acos(cosa)/PI;
+	}
+
+	m_wnd->ShowData(angle, "Angle");
+}
@@ -59,6 +59,9 @@ public:
 
 	void update(bool breset);
 
+	// evaluate the angle for all states
+	void OnApply();
+
 private:
 	void UpdateAngle();
 
@@ -30,9 +30,15 @@ SOFTWARE.*/
 #include <QPushButton>
 #include <QLineEdit>
 #include <QLabel>
+#include <QMessageBox>
 #include <vector>
 #include "Document.h"
-#include <PostLib/FEAreaCoverage.h>
+#include "MainWindow.h"
+#include "SurfaceMap.h"
+#include "BackgroundTask.h"
+#include <PostLib/FEPostModel.h>
+#include <PostLib/FEMeshData_T.h>
+#include <PostLib/constants.h>
 using namespace std;
 using namespace Post;
 
@@ -43,10 +49,11 @@ public:
 	QPushButton* p2;
 	QLineEdit*	name;
 
-	FEAreaCoverage	m_tool;
+	vector<int>	m_sel1;
+	vector<int>	m_sel2;
 
 public:
-	CAreaCoverageToolUI(CAreaCoverageTool* tool) : m_tool(nullptr)
+	CAreaCoverageToolUI(CAreaCoverageTool* tool)
 	{
 		name = new QLineEdit; name->setPlaceholderText("Enter name here");
 		p1 = new QPushButton("Assign to surface 1");
@@ -92,7 +99,7 @@ void CAreaCoverageTool::OnAssign1()
 	{
 		vector<int> sel;
 		doc->GetGLModel()->GetSelectionList(sel, SELECT_FACES);
-		ui->m_tool.SetSelection1(sel);
+		ui->m_sel1 = sel;
 		int n = (int)sel.size();
 		ui->p1->setText(QString("Assign to surface 1 (%1 faces)").arg(n));
 	}
@@ -105,7 +112,7 @@ void CAreaCoverageTool::OnAssign2()
 	{
 		vector<int> sel;
 		doc->GetGLModel()->GetSelectionList(sel, SELECT_FACES);
-		ui->m_tool.SetSelection2(sel);
+		ui->m_sel2 = sel;
 		int n = (int)sel.size();
 		ui->p2->setText(QString("Assign to surface 2 (%1 faces)").arg(n));
 	}
@@ -116,16 +123,43 @@ void CAreaCoverageTool::OnApply()
 	CDocument* doc = GetActiveDocument();
 	if (doc && doc->IsValid())
 	{
-/*		FEAreaCoverage& tool = ui->m_tool;
+		if (ui->m_sel1.empty() || ui->m_sel2.empty())
+		{
+			QMessageBox::information(m_wnd, "Area Coverage", "Please assign both surfaces first.");
+			return;
+		}
+
+		string name = "area coverage";
+		if (ui->name->text().isEmpty() == false) name = ui->name->text().toStdString();
+
+		FEPostModel& fem = *doc->GetFEModel();
+		FEDataField* pdf = new FEDataField_T<FENodeData<float> >(name.c_str(), EXPORT_DATA);
+		fem.AddDataField(pdf);
+		int nfield = pdf->GetFieldID();
+
+		Post::FEPostMesh& mesh = *doc->GetActiveMesh();
 
-		tool.SetDataFieldName("");
-		QString name = ui->name->text();
-		if (name.isEmpty() == false)
+		vector<double> area;
+		CTaskProgress progress;
+		bool bdone = RunBackgroundTask(m_wnd, "Calculating area coverage ...", progress, [&]() {
+			CalculateAreaCoverage(fem, mesh, nfield, ui->m_sel1, ui->m_sel2, area, &progress);
+		});
+
+		// don't leave a partially calculated field
+		if (bdone == false)
 		{
-			tool.SetDataFieldName(name.toStdString());
+			fem.DeleteDataField(pdf);
+			return;
 		}
-		tool.Apply(doc->GetFEModel());
+
+		doc->UpdateObservers(true);
 		updateUi();
-*/
+
+		// this tool adds a data field to the model
+		// so we need to update the main toolbar
+		m_wnd->UpdateMainToolbar();
+
+		// show the covered area as a function of time
+		m_wnd->ShowData(area, QString::fromStdString(name));
 	}
 }
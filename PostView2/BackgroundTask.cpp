@@ -0,0 +1,138 @@
+/*This file is part of the PostView source code and is licensed under the MIT license
+listed below.
+
+See Copyright-PostView.txt for details.
+
+Copyright (c) 2020 University of Utah, The Trustees of Columbia University in 
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#include "stdafx.h"
+#include "BackgroundTask.h"
+#include <QApplication>
+#include <QProgressDialog>
+#include <QEvent>
+#include <thread>
+#include <chrono>
+
+//-----------------------------------------------------------------------------
+static std::atomic<int> s_runningTasks(0);
+
+bool IsBackgroundTaskRunning()
+{
+	return (s_runningTasks > 0);
+}
+
+//-----------------------------------------------------------------------------
+// Filters out all user input, except for the progress dialog, so that only
+// the Cancel button can be used while a job is running.
+class CTaskInputFilter : public QObject
+{
+public:
+	CTaskInputFilter(QWidget* dlg) : m_dlg(dlg) {}
+
+	bool eventFilter(QObject* obj, QEvent* ev) override
+	{
+		switch (ev->type())
+		{
+		case QEvent::MouseButtonPress:
+		case QEvent::MouseButtonRelease:
+		case QEvent::MouseButtonDblClick:
+		case QEvent::MouseMove:
+		case QEvent::Wheel:
+		case QEvent::KeyPress:
+		case QEvent::KeyRelease:
+		case QEvent::Shortcut:
+		case QEvent::ShortcutOverride:
+		case QEvent::TouchBegin:
+		case QEvent::TouchUpdate:
+		case QEvent::TouchEnd:
+		case QEvent::ContextMenu:
+		case QEvent::DragEnter:
+		case QEvent::DragMove:
+		case QEvent::Drop:
+			{
+				QWidget* w = qobject_cast<QWidget*>(obj);
+				if ((w == nullptr) || ((w != m_dlg) && (m_dlg->isAncestorOf(w) == false))) return true;
+			}
+			break;
+		default:
+			break;
+		}
+		return false;
+	}
+
+private:
+	QWidget*	m_dlg;
+};
+
+//-----------------------------------------------------------------------------
+bool RunBackgroundTask(QWidget* parent, const QString& label, CTaskProgress& progress, const std::function<void()>& job)
+{
+	// let the rest of the application know that the model is being worked on
+	s_runningTasks++;
+
+	std::atomic<bool> done(false);
+	std::thread worker([&]() {
+		job();
+		done = true;
+	});
+
+	// the dialog is application modal, so the user cannot change the model while the job runs
+	QProgressDialog dlg(label, "Cancel", 0, 100, parent);
+	dlg.setWindowModality(Qt::ApplicationModal);
+	dlg.setMinimumDuration(500);
+	dlg.setAutoClose(false);
+	dlg.setAutoReset(false);
+	dlg.setValue(0);
+	if (progress.IsCancellable() == false) dlg.setCancelButton(nullptr);
+
+	CTaskInputFilter filter(&dlg);
+	qApp->installEventFilter(&filter);
+
+	while (done == false)
+	{
+		// show a busy indicator if the amount of work is not known
+		if (progress.Total() == 0)
+		{
+			if (dlg.maximum() != 0) dlg.setRange(0, 0);
+		}
+		else
+		{
+			if (dlg.maximum() == 0) dlg.setRange(0, 100);
+			int n = (int)(100.f*progress.Progress());
+			if (n > 99) n = 99;
+			if (n != dlg.value()) dlg.setValue(n);
+		}
+
+		if (dlg.wasCanceled() && progress.IsCancellable()) progress.Cancel();
+
+		QApplication::processEvents(QEventLoop::AllEvents, 50);
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	worker.join();
+
+	qApp->removeEventFilter(&filter);
+	dlg.close();
+
+	s_runningTasks--;
+
+	return (progress.IsCancelled() == false);
+}
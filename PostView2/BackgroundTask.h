@@ -0,0 +1,82 @@
+/*This file is part of the PostView source code and is licensed under the MIT license
+listed below.
+
+See Copyright-PostView.txt for details.
+
+Copyright (c) 2020 University of Utah, The Trustees of Columbia University in 
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#pragma once
+#include <atomic>
+#include <functional>
+#include <QString>
+
+class QWidget;
+
+//-----------------------------------------------------------------------------
+// Progress and cancellation state that is shared between a background job
+// and the UI that monitors it. All members can be called from any thread.
+class CTaskProgress
+{
+public:
+	CTaskProgress(int total = 0) : m_done(0), m_total(total), m_cancel(false), m_canCancel(true) {}
+
+	// set/get the total amount of work (zero if unknown)
+	void SetTotal(int n) { m_total = n; }
+	int Total() const { return m_total; }
+
+	// report completed work
+	void Increment(int n = 1) { m_done += n; }
+
+	// fraction of the work that is done
+	float Progress() const
+	{
+		int total = m_total;
+		return (total > 0 ? (float)m_done / (float)total : 0.f);
+	}
+
+	// request the job to stop
+	void Cancel() { m_cancel = true; }
+	bool IsCancelled() const { return m_cancel; }
+
+	// jobs that never check IsCancelled should turn this off, so that the
+	// progress dialog does not offer a Cancel button
+	void SetCancellable(bool b) { m_canCancel = b; }
+	bool IsCancellable() const { return m_canCancel; }
+
+private:
+	std::atomic<int>	m_done;
+	std::atomic<int>	m_total;
+	std::atomic<bool>	m_cancel;
+	std::atomic<bool>	m_canCancel;
+};
+
+//-----------------------------------------------------------------------------
+// Runs the job on a worker thread and shows a modal progress dialog until it
+// finishes. Pressing Cancel sets the progress' cancel flag, which the job is
+// expected to check regularly. Returns false if the job was cancelled.
+// While the job runs, user input only reaches the progress dialog. Timers and
+// paint events are still processed, so code that reads or changes the model
+// from those (animation, graph updates, rendering) must check IsBackgroundTaskRunning.
+bool RunBackgroundTask(QWidget* parent, const QString& label, CTaskProgress& progress, const std::function<void()>& job);
+
+// returns true while a job started by RunBackgroundTask is running
+bool IsBackgroundTaskRunning();
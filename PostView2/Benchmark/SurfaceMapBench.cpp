@@ -0,0 +1,211 @@
+/*This file is part of the PostView source code and is licensed under the MIT license
+listed below.
+
+See Copyright-PostView.txt for details.
+
+Copyright (c) 2020 University of Utah, The Trustees of Columbia University in 
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+//-----------------------------------------------------------------------------
+// Compares the surface map kernels of PostView (SurfaceMap.h) with the PostLib
+// classes they replace (FEDistanceMap and FEAreaCoverage), for speed and for
+// agreement of the results.
+//
+// usage: SurfaceMapBench file.xplt surface1 surface2
+//
+// The surfaces are given by the group ID of their faces. The differences are
+// only meaningful for flat, linear faces, since the two implementations
+// represent curved and higher-order faces differently.
+
+#include "../stdafx.h"
+#include "../SurfaceMap.h"
+#include "../SurfaceTree.h"
+#include <XPLTLib/xpltFileReader.h>
+#include <PostLib/FEPostModel.h>
+#include <PostLib/FEMeshData_T.h>
+#include <PostLib/FEDistanceMap.h>
+#include <PostLib/FEAreaCoverage.h>
+#include <PostLib/constants.h>
+#include <chrono>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+using namespace std;
+using namespace Post;
+
+//-----------------------------------------------------------------------------
+// time since start in seconds
+static double Seconds(chrono::steady_clock::time_point start)
+{
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+//-----------------------------------------------------------------------------
+// largest difference of two nodal fields over the nodes of the faces in sel, for all states
+static float MaxNodeDifference(FEPostModel& fem, Post::FEPostMesh& mesh, int nfield0, int nfield1, const vector<int>& sel)
+{
+	vector<int> tag(mesh.Nodes(), 0);
+	for (int i : sel)
+	{
+		FEFace& f = mesh.Face(i);
+		for (int j = 0; j < f.Nodes(); ++j) tag[f.n[j]] = 1;
+	}
+
+	int n0 = FIELD_CODE(nfield0);
+	int n1 = FIELD_CODE(nfield1);
+	float dmax = 0.f;
+	for (int n = 0; n < fem.GetStates(); ++n)
+	{
+		FEState* ps = fem.GetState(n);
+		FENodeData<float>& d0 = dynamic_cast<FENodeData<float>&>(ps->m_Data[n0]);
+		FENodeData<float>& d1 = dynamic_cast<FENodeData<float>&>(ps->m_Data[n1]);
+		for (int i = 0; i < mesh.Nodes(); ++i)
+		{
+			if (tag[i] == 0) continue;
+			float d = fabs(d0[i] - d1[i]);
+			if (d > dmax) dmax = d;
+		}
+	}
+	return dmax;
+}
+
+//-----------------------------------------------------------------------------
+static void BenchDistanceMap(FEPostModel& fem, Post::FEPostMesh& mesh, const vector<int>& sel1, const vector<int>& sel2, bool bsigned)
+{
+	FEDataField* map = new FEDataField_T<FENodeData<float> >("distance map", EXPORT_DATA);
+	fem.AddDataField(map);
+	auto t0 = chrono::steady_clock::now();
+	CalculateDistanceMap(fem, mesh, map->GetFieldID(), sel1, sel2, bsigned);
+	double t = Seconds(t0);
+
+	FEDistanceMap* ref = new FEDistanceMap(&fem);
+	fem.AddDataField(ref);
+	ref->m_bsigned = bsigned;
+	ref->SetSelection1(sel1);
+	ref->SetSelection2(sel2);
+	t0 = chrono::steady_clock::now();
+	ref->Apply();
+	double tref = Seconds(t0);
+
+	float dmax = MaxNodeDifference(fem, mesh, map->GetFieldID(), ref->GetFieldID(), sel1);
+	printf("distance map (%s): %8.3f s, FEDistanceMap: %8.3f s, max. difference = %g\n", (bsigned ? "signed" : "unsigned"), t, tref, dmax);
+
+	fem.DeleteDataField(ref);
+	fem.DeleteDataField(map);
+}
+
+//-----------------------------------------------------------------------------
+// Compares the covered area of each state. FEAreaCoverage's result is integrated
+// over the faces of surface 1, with the face values evaluated by the model.
+static void BenchAreaCoverage(FEPostModel& fem, Post::FEPostMesh& mesh, const vector<int>& sel1, const vector<int>& sel2)
+{
+	FEDataField* map = new FEDataField_T<FENodeData<float> >("area coverage", EXPORT_DATA);
+	fem.AddDataField(map);
+	vector<double> area;
+	auto t0 = chrono::steady_clock::now();
+	CalculateAreaCoverage(fem, mesh, map->GetFieldID(), sel1, sel2, area);
+	double t = Seconds(t0);
+
+	FEAreaCoverage ref(&fem);
+	ref.SetSelection1(sel1);
+	ref.SetSelection2(sel2);
+	ref.SetDataFieldName("area coverage (FEAreaCoverage)");
+	t0 = chrono::steady_clock::now();
+	ref.Apply(&fem);
+	double tref = Seconds(t0);
+
+	FEDataManager& dm = *fem.GetDataManager();
+	FEDataField* pdf = *dm.DataField(dm.DataFields() - 1);
+	int nref = pdf->GetFieldID();
+
+	double dmax = 0.0;
+	float data[FEFace::MAX_NODES], val;
+	for (int n = 0; n < fem.GetStates(); ++n)
+	{
+		double Atot = 0.0, Aref = 0.0;
+		for (int i : sel1)
+		{
+			FEFace& f = mesh.Face(i);
+			int ntri;
+			const int* lt = FaceTriangulation(f.Nodes(), ntri);
+			float A = 0.f;
+			for (int j = 0; j < ntri; ++j, lt += 3)
+			{
+				vec3f a = fem.NodePosition(f.n[lt[0]], n);
+				vec3f b = fem.NodePosition(f.n[lt[1]], n);
+				vec3f c = fem.NodePosition(f.n[lt[2]], n);
+				A += 0.5f*((b - a) ^ (c - a)).Length();
+			}
+			fem.EvaluateFace(i, n, nref, data, val);
+			Aref += A*val;
+			Atot += A;
+		}
+		if (Atot > 0.0)
+		{
+			double d = fabs(area[n] - Aref) / Atot;
+			if (d > dmax) dmax = d;
+		}
+	}
+	printf("area coverage: %8.3f s, FEAreaCoverage: %8.3f s, max. relative area difference = %g\n", t, tref, dmax);
+
+	fem.DeleteDataField(pdf);
+	fem.DeleteDataField(map);
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	if (argc != 4)
+	{
+		printf("usage: SurfaceMapBench file.xplt surface1 surface2\n");
+		return 1;
+	}
+
+	FEPostModel fem;
+	xpltFileReader reader(nullptr);
+	reader.SetPostModel(&fem);
+	if (reader.Load(argv[1]) == false)
+	{
+		printf("Failed to read %s\n", argv[1]);
+		return 1;
+	}
+
+	// collect the faces of both surfaces
+	Post::FEPostMesh& mesh = *fem.GetFEMesh(0);
+	int gid1 = atoi(argv[2]);
+	int gid2 = atoi(argv[3]);
+	vector<int> sel1, sel2;
+	for (int i = 0; i < mesh.Faces(); ++i)
+	{
+		FEFace& f = mesh.Face(i);
+		if (f.m_gid == gid1) sel1.push_back(i);
+		if (f.m_gid == gid2) sel2.push_back(i);
+	}
+	printf("%d states, %d nodes, surface 1: %d faces, surface 2: %d faces\n", fem.GetStates(), mesh.Nodes(), (int)sel1.size(), (int)sel2.size());
+	if (sel1.empty() || sel2.empty()) return 1;
+
+	BenchDistanceMap(fem, mesh, sel1, sel2, false);
+	BenchDistanceMap(fem, mesh, sel1, sel2, true);
+	BenchAreaCoverage(fem, mesh, sel1, sel2);
+
+	return 0;
+}
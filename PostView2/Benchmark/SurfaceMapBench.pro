@@ -0,0 +1,27 @@
+######################################################################
+# Command line benchmark for the surface map kernels (see SurfaceMapBench.cpp)
+######################################################################
+
+TEMPLATE = app
+DESTDIR = ../../build/bin
+TARGET = SurfaceMapBench
+CONFIG += console c++14 warn_off
+CONFIG -= app_bundle
+QMAKE_CXX = g++
+QMAKE_CXXFLAGS += -DLINUX -DNDEBUG
+QMAKE_CXXFLAGS += -MMD -fPIC
+QMAKE_CXXFLAGS_RELEASE += -O3
+QMAKE_CXXFLAGS_RELEASE -= -O2
+INCLUDEPATH += ../
+INCLUDEPATH += /home/mherron/Projects/FEBioStudio/
+QT += core
+
+LIBS += -L/home/mherron/Projects/FEBioStudio/build/lib
+LIBS += -Wl,--start-group
+LIBS += -lxpltlib -lpostlib -lfscore -lmeshlib -lmathlib
+LIBS += -Wl,--end-group
+LIBS += -lpthread -lz -lm
+
+# Input
+HEADERS += ../SurfaceMap.h ../SurfaceTree.h ../BackgroundTask.h ../ParallelFor.h
+SOURCES = SurfaceMapBench.cpp ../SurfaceMap.cpp ../SurfaceTree.cpp
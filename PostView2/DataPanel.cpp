@@ -51,6 +51,7 @@ SOFTWARE.*/
 #include <PostLib/FEMeshData_T.h>
 #include <PostLib/FEMathData.h>
 #include "DlgAddEquation.h"
+#include "BackgroundTask.h"
 using namespace Post;
 
 class CCurvatureProps : public CPropertyList
@@ -801,6 +802,7 @@ void CDataPanel::on_DeleteButton_clicked()
 			if (QMessageBox::question(this, "Delete Data Field", sz) == QMessageBox::Yes)
 			{
 				fem.DeleteDataField(pdf);
+				doc.InvalidateData();
 				Update(true);
 			}
 		}
@@ -853,25 +855,54 @@ void CDataPanel::on_FilterButton_clicked()
 				FEDataField* newData = 0;
 				bool bret = true;
 				int nfield = pdf->GetFieldID();
+
+				// The filters can take a long time on large models, so they are run in the
+				// background. Most filters are a single PostLib call that processes all
+				// states and cannot be interrupted, so they don't offer a Cancel button.
+				// Smoothing is done one iteration at a time and can be cancelled in
+				// between. If it is, the new data field is removed again.
+				CTaskProgress progress;
+				progress.SetCancellable(false);
+				bool bdone = true;
 				switch(dlg.m_nflt)
 				{
 				case 0:
 					{
 						newData = fem.CreateCachedCopy(pdf, sname.c_str());
-						bret = DataScale(fem, newData->GetFieldID(), dlg.m_scale);
+						int ndst = newData->GetFieldID();
+						bdone = RunBackgroundTask(this, "Scaling data ...", progress, [&]() {
+							bret = DataScale(fem, ndst, dlg.m_scale);
+						});
 					}
 					break;
 				case 1:
 					{
 						newData = fem.CreateCachedCopy(pdf, sname.c_str());
-						bret = DataSmooth(fem, newData->GetFieldID(), dlg.m_theta, dlg.m_iters);
+						int ndst = newData->GetFieldID();
+
+						// smooth one iteration at a time, so we can report progress and cancel in between
+						progress.SetTotal(dlg.m_iters);
+						progress.SetCancellable(true);
+						bdone = RunBackgroundTask(this, "Smoothing data ...", progress, [&]() {
+							for (int i = 0; i < dlg.m_iters; ++i)
+							{
+								if (progress.IsCancelled()) return;
+								bret = DataSmooth(fem, ndst, dlg.m_theta, 1);
+								if (bret == false) return;
+								progress.Increment();
+							}
+						});
 					}
 					break;
 				case 2:
 					{
 						newData = fem.CreateCachedCopy(pdf, sname.c_str());
+						int ndst = newData->GetFieldID();
 						FEDataFieldPtr p = fem.GetDataManager()->DataField(dataIds[dlg.m_ndata]);
-						bret = DataArithmetic(fem, newData->GetFieldID(), dlg.m_nop, (*p)->GetFieldID());
+						int nsrc = (*p)->GetFieldID();
+						bdone = RunBackgroundTask(this, "Applying operation ...", progress, [&]() {
+							bret = DataArithmetic(fem, ndst, dlg.m_nop, nsrc);
+						});
 					}
 					break;
 				case 3:
@@ -881,14 +912,20 @@ void CDataPanel::on_FilterButton_clicked()
 						fem.AddDataField(newData);
 
 						// now, calculate gradient from scalar field
-						bret = DataGradient(fem, newData->GetFieldID(), nfield);
+						int ndst = newData->GetFieldID();
+						bdone = RunBackgroundTask(this, "Calculating gradient ...", progress, [&]() {
+							bret = DataGradient(fem, ndst, nfield);
+						});
 					}
 					break;
 				case 4:
 					{
 						// create new field for storing the component
-						newData = DataComponent(fem, pdf, dlg.getArrayComponent(), sname);
-						if (newData == 0)
+						int ncomp = dlg.getArrayComponent();
+						bdone = RunBackgroundTask(this, "Extracting component ...", progress, [&]() {
+							newData = DataComponent(fem, pdf, ncomp, sname);
+						});
+						if (bdone && (newData == 0))
 						{
 							QMessageBox::critical(this, "Data Filter", "Failed to extract component.");
 						}
@@ -900,14 +937,22 @@ void CDataPanel::on_FilterButton_clicked()
 						fem.AddDataField(newData);
 
 						// calculate fractional anisotropy
-						bret = DataFractionalAnsisotropy(fem, newData->GetFieldID(), nfield);
+						int ndst = newData->GetFieldID();
+						bdone = RunBackgroundTask(this, "Calculating fractional anisotropy ...", progress, [&]() {
+							bret = DataFractionalAnsisotropy(fem, ndst, nfield);
+						});
 					}
 					break;
 				default:
 					QMessageBox::critical(this, "Data Filter", "Don't know this filter.");
 				}
 
-				if (bret == false)
+				if (bdone == false)
+				{
+					// smoothing was cancelled, so remove the partially smoothed data
+					if (newData) fem.DeleteDataField(newData);
+				}
+				else if (bret == false)
 				{
 					if (newData) fem.DeleteDataField(newData);
 					QMessageBox::critical(this, "Data Filter", "Cannot apply this filter.");
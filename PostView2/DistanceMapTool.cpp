@@ -42,10 +42,26 @@ SOFTWARE.*/
 #include <QFileDialog>
 #include <QMessageBox>
 #include <PostGL/GLLinePlot.h>
-#include <PostLib/FEDistanceMap.h>
+#include <PostLib/FEMeshData_T.h>
 #include <PostLib/FECurvatureMap.h>
+#include <PostLib/constants.h>
+#include "SurfaceMap.h"
+#include "BackgroundTask.h"
 using namespace Post;
 
+//-----------------------------------------------------------------------------
+// see if the data field is still part of the model
+static bool HasDataField(FEPostModel& fem, FEDataField* pdf)
+{
+	FEDataManager& dm = *fem.GetDataManager();
+	for (int i = 0; i < dm.DataFields(); ++i)
+	{
+		if (*dm.DataField(i) == pdf) return true;
+	}
+	return false;
+}
+
+
 class CDistanceMapToolUI : public QWidget
 {
 public:
@@ -56,12 +72,14 @@ public:
 	vector<int>	m_sel1;
 	vector<int>	m_sel2;
 
-	FEDistanceMap*	m_map;
+	FEDataField*	m_map;
+	unsigned int	m_modelID;	// model that m_map belongs to
 
 public:
 	CDistanceMapToolUI(CDistanceMapTool* ptool)
 	{
 		m_map = nullptr;
+		m_modelID = 0;
 		QPushButton* apply;
 		QVBoxLayout* pv = new QVBoxLayout;
 		{
@@ -127,17 +145,52 @@ void CDistanceMapTool::OnApply()
 	if (doc && doc->IsValid())
 	{
 		bool bcheck = ui->check->isChecked();
-		FEDistanceMap* map = ui->m_map;
-		if (map == nullptr)
+		Post::FEPostModel* fem = doc->GetFEModel();
+
+		// The map is calculated into a new field, so that a cancelled calculation
+		// leaves the model as it was. If the tool already made a map for this model,
+		// the new values are then copied to it, so that it keeps its place in the list.
+		FEDataField* oldMap = ui->m_map;
+		if ((ui->m_modelID != doc->GetModelID()) || (oldMap && (HasDataField(*fem, oldMap) == false))) oldMap = nullptr;
+
+		FEDataField* map = new FEDataField_T<FENodeData<float> >("distance map", EXPORT_DATA);
+		fem->AddDataField(map);
+
+		int nfield = map->GetFieldID();
+		Post::FEPostMesh& mesh = *doc->GetActiveMesh();
+		CTaskProgress progress;
+		bool bdone = RunBackgroundTask(m_wnd, "Calculating distance map ...", progress, [&]() {
+			CalculateDistanceMap(*fem, mesh, nfield, ui->m_sel1, ui->m_sel2, bcheck, &progress);
+		});
+
+		if (bdone == false)
 		{
-			Post::FEPostModel* fem = doc->GetFEModel();
-			map = new FEDistanceMap(fem);
-			fem->AddDataField(map);
+			fem->DeleteDataField(map);
 		}
-		map->m_bsigned = bcheck;
-		map->SetSelection1(ui->m_sel1);
-		map->SetSelection2(ui->m_sel2);
-		map->Apply();
+		else
+		{
+			if (oldMap)
+			{
+				int nsrc = FIELD_CODE(nfield);
+				int ndst = FIELD_CODE(oldMap->GetFieldID());
+				for (int n = 0; n < fem->GetStates(); ++n)
+				{
+					FEState* ps = fem->GetState(n);
+					FENodeData<float>& src = dynamic_cast<FENodeData<float>&>(ps->m_Data[nsrc]);
+					FENodeData<float>& dst = dynamic_cast<FENodeData<float>&>(ps->m_Data[ndst]);
+					for (int i = 0; i < mesh.Nodes(); ++i) dst[i] = src[i];
+				}
+				fem->DeleteDataField(map);
+				map = oldMap;
+			}
+
+			ui->m_map = map;
+			ui->m_modelID = doc->GetModelID();
+
+			// the values of an existing field may have changed
+			doc->InvalidateData();
+		}
+
 		doc->UpdateObservers(true);
 		updateUi();
 	}
@@ -215,8 +268,15 @@ void CCurvatureMapTool::OnApply()
 	CDocument* doc = GetActiveDocument();
 	if (doc && doc->IsValid())
 	{
+		// The map can take a while, so run it in the background. It is a single call
+		// that cannot be interrupted, so the progress dialog has no Cancel button.
 		FECongruencyMap& map = ui->m_map;
-		map.Apply(*doc->GetFEModel());
+		FEPostModel& fem = *doc->GetFEModel();
+		CTaskProgress progress;
+		progress.SetCancellable(false);
+		RunBackgroundTask(m_wnd, "Calculating curvature map ...", progress, [&]() {
+			map.Apply(fem);
+		});
 		updateUi();
 
 		// this tool adds a data field to the model
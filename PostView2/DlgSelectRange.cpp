@@ -30,13 +30,18 @@ SOFTWARE.*/
 #include <QFormLayout>
 #include <QCheckBox>
 #include <QDialogButtonBox>
+#include <QPushButton>
 #include "CIntInput.h"
+#include "Document.h"
+#include "BackgroundTask.h"
+#include <PostGL/GLModel.h>
 
 class Ui::CDlgSelectRange
 {
 public:
 	CFloatInput *pmin, *pmax;
 	QCheckBox* prange;
+	QPushButton* pall;
 
 public:
 	void setupUi(QDialog* parent)
@@ -48,6 +53,11 @@ public:
 		pform->addRow("max:", pmax = new CFloatInput);
 		pv->addLayout(pform);
 
+		QHBoxLayout* ph = new QHBoxLayout;
+		ph->addStretch();
+		ph->addWidget(pall = new QPushButton("Range over all states"));
+		pv->addLayout(ph);
+
 		prange = new QCheckBox("Apply to current selection");
 		pv->addWidget(prange);
 
@@ -58,11 +68,14 @@ public:
 
 		QObject::connect(pb, SIGNAL(accepted()), parent, SLOT(accept()));
 		QObject::connect(pb, SIGNAL(rejected()), parent, SLOT(reject()));
+		QObject::connect(pall, SIGNAL(clicked()), parent, SLOT(onAllStates()));
 	}
 };
 
-CDlgSelectRange::CDlgSelectRange(QWidget* parent) : QDialog(parent), ui(new Ui::CDlgSelectRange)
+CDlgSelectRange::CDlgSelectRange(CDocument* doc, QWidget* parent) : QDialog(parent), ui(new Ui::CDlgSelectRange)
 {
+	m_doc = doc;
+
 	ui->setupUi(this);
 
 	ui->pmin->setValue(0);
@@ -85,3 +98,38 @@ void CDlgSelectRange::accept()
 
 	QDialog::accept();
 }
+
+// Sets the range to the range of the active data field over all states. The ranges are
+// cached by the document, so this only takes time the first time it is requested.
+void CDlgSelectRange::onAllStates()
+{
+	if ((m_doc == nullptr) || (m_doc->IsValid() == false)) return;
+
+	Post::CGLModel& mdl = *m_doc->GetGLModel();
+	int nfield = m_doc->GetEvalField();
+	if (nfield < 0) return;
+
+	// evaluate the range over the items that are being selected
+	int nitem = -1;
+	switch (mdl.GetSelectionMode())
+	{
+	case Post::SELECT_NODES: nitem = RANGE_NODES; break;
+	case Post::SELECT_EDGES: nitem = RANGE_EDGES; break;
+	case Post::SELECT_FACES: nitem = RANGE_FACES; break;
+	case Post::SELECT_ELEMS: nitem = RANGE_ELEMS; break;
+	}
+
+	float fmin = 0.f, fmax = 0.f;
+	CTaskProgress progress;
+	CFieldStats& stats = m_doc->GetFieldStats();
+	bool bret = false;
+	bool bdone = RunBackgroundTask(this, "Evaluating all states ...", progress, [&]() {
+		bret = stats.GetGlobalRange(mdl, nfield, fmin, fmax, nitem, &progress);
+	});
+
+	if (bdone && bret)
+	{
+		ui->pmin->setValue(fmin);
+		ui->pmax->setValue(fmax);
+	}
+}
@@ -31,10 +31,14 @@ namespace Ui {
 	class CDlgSelectRange;
 };
 
+class CDocument;
+
 class CDlgSelectRange : public QDialog
 {
+	Q_OBJECT
+
 public:
-	CDlgSelectRange(QWidget* parent);
+	CDlgSelectRange(CDocument* doc, QWidget* parent);
 
 public:
 	double m_min, m_max;
@@ -43,6 +47,10 @@ public:
 	void accept();
 	int exec();
 
+private slots:
+	void onAllStates();
+
 private:
 	Ui::CDlgSelectRange* ui;
+	CDocument*	m_doc;
 };
@@ -27,6 +27,7 @@ SOFTWARE.*/
 #include "stdafx.h"
 #include "Document.h"
 #include "MainWindow.h"
+#include "BackgroundTask.h"
 #include <PostLib/FEPostModel.h>
 #include <PostLib/FEFileReader.h>
 #include <ImageLib/3DImage.h>
@@ -232,9 +233,19 @@ void CDocObserver::DocumentDelete()
 }
 
 //=============================================================================
+// generates the model IDs and data revisions
+static unsigned int NewRevision()
+{
+	static unsigned int n = 0;
+	return ++n;
+}
+
+//-----------------------------------------------------------------------------
 CDocument::CDocument(CMainWindow* pwnd) : m_wnd(pwnd)
 {
 	m_bValid = false;
+	m_modelID = NewRevision();
+	m_dataRev = NewRevision();
 
 	m_fem = 0;
 	m_pGLModel = 0;
@@ -335,6 +346,10 @@ void CDocument::Reset()
 	// clear image models
 	for (int i = 0; i < (int)m_img.size(); ++i) delete m_img[i];
 	m_img.clear();
+
+	// the model is gone, so clear everything that was cached for it
+	m_modelID = NewRevision();
+	InvalidateData();
 }
 
 //-----------------------------------------------------------------------------
@@ -391,10 +406,20 @@ void CDocument::UpdateFEModel(bool breset)
 {
 	if (!m_bValid) return;
 
+	// the model data may have changed, so the cached results are no longer valid
+	if (breset) InvalidateData();
+
 	// update the model
 	if (m_pGLModel) m_pGLModel->Update(breset);
 }
 
+//-----------------------------------------------------------------------------
+void CDocument::InvalidateData()
+{
+	m_stats.Clear();
+	m_dataRev = NewRevision();
+}
+
 //-----------------------------------------------------------------------------
 void CDocument::ResetView()
 {
@@ -508,6 +533,8 @@ bool CDocument::LoadFEModel(FEFileReader* pimp, const char* szfile, bool bup)
 	// remove the old scene
 	m_bValid = false;
 	delete m_fem;
+	m_modelID = NewRevision();
+	InvalidateData();
 
 	// create a new model
 	m_fem = new FEPostModel;
@@ -624,6 +651,8 @@ void CDocument::SetFEModel(FEPostModel* pnew)
 	// remove the old FE model
 	m_bValid = false;
 	delete m_fem;
+	m_modelID = NewRevision();
+	InvalidateData();
 
 	// set the new scene
 	m_fem = pnew;
@@ -1253,13 +1282,35 @@ bool CDocument::LoadRAWImage(const std::string& fileName, int dim[3], BOX range)
 }
 
 //------------------------------------------------------------------------------------------
-void CDocument::UpdateAllStates()
+// Evaluates the active data field for all states. Instead of making each state the current one,
+// which updates the render model every time, the states are evaluated directly and the field
+// is only evaluated for states where it is not up to date. This does not touch the render model,
+// so it can be run as a background task; call UpdateFEModel afterwards to refresh the current
+// state. Returns false if it was cancelled. The states are updated one after the other, since
+// both the displacement update and the evaluation modify the model (see ParallelFor.h).
+bool CDocument::UpdateAllStates(CTaskProgress* progress)
 {
-	if (m_bValid == false) return;
+	if (m_bValid == false) return true;
+
+	int nfield = GetEvalField();
 	int N = m_fem->GetStates();
-	int ntime = currentTime();
-	for (int i=0; i<N; ++i) SetCurrentTime(i);
-	SetCurrentTime(ntime);
+	if (progress) progress->SetTotal(N);
+
+	CGLDisplacementMap* pdm = m_pGLModel->GetDisplacementMap();
+	for (int i=0; i<N; ++i)
+	{
+		if (progress && progress->IsCancelled()) return false;
+
+		// the displacements depend on the displacement scale, so they are always updated
+		if (pdm) pdm->UpdateState(i);
+
+		FEState* ps = m_fem->GetState(i);
+		if ((nfield >= 0) && (ps->m_nField != nfield)) m_fem->Evaluate(nfield, i);
+
+		if (progress) progress->Increment();
+	}
+
+	return true;
 }
 
 // get the number of time steps
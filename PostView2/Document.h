@@ -33,6 +33,7 @@ SOFTWARE.*/
 #include <GLLib/GView.h>
 #include <PostLib/FEPostMesh.h>
 #include <PostGL/GLModel.h>
+#include "FieldStats.h"
 
 //-----------------------------------------------------------------------------
 // Forward declarations
@@ -178,8 +179,19 @@ public:
 	// update the FE model data
 	void UpdateFEModel(bool breset = false);
 
-	// update all the states
-	void UpdateAllStates();
+	// The model ID changes when the model is replaced and the data revision when the model's
+	// data changes. They are unique over all documents, so results can be cached against them.
+	unsigned int GetModelID() const { return m_modelID; }
+	unsigned int GetDataRevision() const { return m_dataRev; }
+
+	// call this when the model's data has changed
+	void InvalidateData();
+
+	// evaluate the active data field for all the states
+	bool UpdateAllStates(CTaskProgress* progress = nullptr);
+
+	// get the cached data field ranges
+	CFieldStats& GetFieldStats() { return m_stats; }
 
 	// get the number of time steps
 	int GetTimeSteps();
@@ -331,6 +343,11 @@ protected:
 	// timer data
 	TIMESETTINGS	m_time;
 
+	// cached data field ranges
+	CFieldStats		m_stats;
+	unsigned int	m_modelID;
+	unsigned int	m_dataRev;
+
 	// miscellenaeous
 	bool	m_bValid;	// the document is loaded and valid
 
@@ -0,0 +1,262 @@
+/*This file is part of the PostView source code and is licensed under the MIT license
+listed below.
+
+See Copyright-PostView.txt for details.
+
+Copyright (c) 2020 University of Utah, The Trustees of Columbia University in 
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#include "stdafx.h"
+#include "FieldStats.h"
+#include "BackgroundTask.h"
+#include "ParallelFor.h"
+#include <PostLib/constants.h>
+#include <PostLib/FEPostModel.h>
+#include <PostGL/GLDataMap.h>
+#include <PostGL/GLModel.h>
+#include <vector>
+#include <climits>
+using namespace Post;
+
+// max number of ranges that are cached
+const int MAX_CACHED_RANGES = 100000;
+
+//-----------------------------------------------------------------------------
+// Accumulates the range and average of values. Each thread fills its
+// own accumulator and they are combined at the end.
+class CRangeSum
+{
+public:
+	CRangeSum() : m_fmax(-1e20f), m_fmin(1e20f), m_sum(0.0), m_count(0) {}
+
+	void add(float val)
+	{
+		m_sum += val;
+		m_count++;
+		if (val > m_fmax) m_fmax = val;
+		if (val < m_fmin) m_fmin = val;
+	}
+
+	void add(const CRangeSum& r)
+	{
+		m_sum += r.m_sum;
+		m_count += r.m_count;
+		if (r.m_fmax > m_fmax) m_fmax = r.m_fmax;
+		if (r.m_fmin < m_fmin) m_fmin = r.m_fmin;
+	}
+
+	static FIELD_RANGE combine(const std::vector<CRangeSum>& acc)
+	{
+		CRangeSum r;
+		for (const CRangeSum& ri : acc) r.add(ri);
+
+		FIELD_RANGE rng = { r.m_fmax, r.m_fmin, 0.f };
+		if (r.m_count == 0) rng.fmin = rng.fmax = 0.f;
+		else rng.favg = (float)(r.m_sum / r.m_count);
+		return rng;
+	}
+
+private:
+	float	m_fmax, m_fmin;
+	double	m_sum;
+	int		m_count;
+};
+
+//-----------------------------------------------------------------------------
+// Evaluate the range of unpacked nodal data values
+FIELD_RANGE EvalNodeRange(FEPostModel& fem, int nstate, bool bsel)
+{
+	FEState& state = *fem.GetState(nstate);
+	Post::FEPostMesh& mesh = *state.GetFEMesh();
+
+	std::vector<CRangeSum> acc(ParallelThreads());
+	ParallelForThread(mesh.Nodes(), [&](int i, int thread) {
+		FENode& node = mesh.Node(i);
+		if ((bsel == false) || (node.IsSelected()))
+		{
+			acc[thread].add(state.m_NODE[i].m_val);
+		}
+	});
+
+	return CRangeSum::combine(acc);
+}
+
+//-----------------------------------------------------------------------------
+// Evaluate the range of unpacked edge data values
+FIELD_RANGE EvalEdgeRange(FEPostModel& fem, int nstate, bool bsel)
+{
+	FEState& state = *fem.GetState(nstate);
+	Post::FEPostMesh& mesh = *state.GetFEMesh();
+
+	std::vector<CRangeSum> acc(ParallelThreads());
+	ParallelForThread(mesh.Edges(), [&](int i, int thread) {
+		FEEdge& edge = mesh.Edge(i);
+		if ((bsel == false) || (edge.IsSelected()))
+		{
+			acc[thread].add(state.m_EDGE[i].m_val);
+		}
+	});
+
+	return CRangeSum::combine(acc);
+}
+
+//-----------------------------------------------------------------------------
+// Evaluate the range of unpacked element data values
+FIELD_RANGE EvalElemRange(FEPostModel& fem, int nstate, bool bsel)
+{
+	FEState& state = *fem.GetState(nstate);
+	Post::FEPostMesh& mesh = *state.GetFEMesh();
+
+	ValArray& elemData = state.m_ElemData;
+
+	std::vector<CRangeSum> acc(ParallelThreads());
+	ParallelForThread(mesh.Elements(), [&](int i, int thread) {
+		FEElement_& e = mesh.ElementRef(i);
+		int ne = e.Nodes();
+
+		if ((bsel == false) || (e.IsSelected()))
+		{
+			for (int j=0; j<ne; ++j)
+			{
+				acc[thread].add(elemData.value(i, j));
+			}
+		}
+	});
+
+	return CRangeSum::combine(acc);
+}
+
+//-----------------------------------------------------------------------------
+// Evaluate the range of unpacked face data values
+FIELD_RANGE EvalFaceRange(FEPostModel& fem, int nstate, bool bsel)
+{
+	FEState& state = *fem.GetState(nstate);
+	Post::FEPostMesh& mesh = *state.GetFEMesh();
+
+	std::vector<CRangeSum> acc(ParallelThreads());
+	ParallelForThread(mesh.Faces(), [&](int i, int thread) {
+		FEFace& f = mesh.Face(i);
+
+		if ((bsel == false) || (f.IsSelected()))
+		{
+			acc[thread].add(state.m_FACE[i].m_val);
+		}
+	});
+
+	return CRangeSum::combine(acc);
+}
+
+//=============================================================================
+CFieldStats::CFieldStats()
+{
+}
+
+//-----------------------------------------------------------------------------
+void CFieldStats::Clear()
+{
+	m_range.clear();
+}
+
+//-----------------------------------------------------------------------------
+void CFieldStats::ClearSelection()
+{
+	// the ranges over the selection are sorted last
+	m_range.erase(m_range.lower_bound(std::make_tuple(true, INT_MIN, INT_MIN, INT_MIN)), m_range.end());
+}
+
+//-----------------------------------------------------------------------------
+FIELD_RANGE CFieldStats::GetRange(CGLModel& mdl, int nfield, int nstate, int nitem, bool bsel)
+{
+	// figure out which items the field is defined on
+	if (nitem < 0)
+	{
+		if      (IS_NODE_FIELD(nfield)) nitem = RANGE_NODES;
+		else if (IS_EDGE_FIELD(nfield)) nitem = RANGE_EDGES;
+		else if (IS_FACE_FIELD(nfield)) nitem = RANGE_FACES;
+		else nitem = RANGE_ELEMS;
+	}
+
+	std::tuple<bool, int, int, int> key(bsel, nfield, nitem, nstate);
+	std::map<std::tuple<bool, int, int, int>, FIELD_RANGE>::iterator it = m_range.find(key);
+	if (it != m_range.end()) return it->second;
+
+	FIELD_RANGE rng = Evaluate(mdl, nfield, nstate, nitem, bsel);
+
+	if ((int)m_range.size() >= MAX_CACHED_RANGES) m_range.clear();
+	m_range[key] = rng;
+
+	return rng;
+}
+
+//-----------------------------------------------------------------------------
+bool CFieldStats::GetGlobalRange(CGLModel& mdl, int nfield, float& fmin, float& fmax, int nitem, CTaskProgress* progress)
+{
+	FEPostModel& fem = *mdl.GetFEModel();
+	int nstates = fem.GetStates();
+	if (progress) progress->SetTotal(nstates);
+
+	fmin = fmax = 0.f;
+	for (int i=0; i<nstates; ++i)
+	{
+		if (progress && progress->IsCancelled()) return false;
+
+		FIELD_RANGE rng = GetRange(mdl, nfield, i, nitem);
+		if ((i == 0) || (rng.fmin < fmin)) fmin = rng.fmin;
+		if ((i == 0) || (rng.fmax > fmax)) fmax = rng.fmax;
+
+		if (progress) progress->Increment();
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Evaluates the field for the state and finds its range. The field that was
+// previously evaluated for the state is restored afterwards.
+FIELD_RANGE CFieldStats::Evaluate(CGLModel& mdl, int nfield, int nstate, int nitem, bool bsel)
+{
+	FEPostModel& fem = *mdl.GetFEModel();
+	FEState* ps = fem.GetState(nstate);
+
+	// we need to make sure that the displacements are updated
+	// in case the field depends on them (e.g. strains)
+	CGLDisplacementMap* pdm = mdl.GetDisplacementMap();
+	if (pdm) pdm->UpdateState(nstate);
+
+	// evaluate the field
+	int noldField = ps->m_nField;
+	if (noldField != nfield) fem.Evaluate(nfield, nstate);
+
+	FIELD_RANGE rng;
+	switch (nitem)
+	{
+	case RANGE_NODES: rng = EvalNodeRange(fem, nstate, bsel); break;
+	case RANGE_EDGES: rng = EvalEdgeRange(fem, nstate, bsel); break;
+	case RANGE_FACES: rng = EvalFaceRange(fem, nstate, bsel); break;
+	default:
+		rng = EvalElemRange(fem, nstate, bsel);
+	}
+
+	// reset the field data
+	if ((noldField >= 0) && (noldField != nfield)) fem.Evaluate(noldField, nstate);
+
+	return rng;
+}
@@ -0,0 +1,95 @@
+/*This file is part of the PostView source code and is licensed under the MIT license
+listed below.
+
+See Copyright-PostView.txt for details.
+
+Copyright (c) 2020 University of Utah, The Trustees of Columbia University in 
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#pragma once
+#include <map>
+#include <tuple>
+
+namespace Post {
+	class FEPostModel;
+	class CGLModel;
+}
+
+class CTaskProgress;
+
+//-----------------------------------------------------------------------------
+// Range and average of the values of a data field.
+struct FIELD_RANGE
+{
+	float	fmax, fmin, favg;
+};
+
+//-----------------------------------------------------------------------------
+// The items a range can be evaluated over.
+enum FieldRangeItem
+{
+	RANGE_NODES,
+	RANGE_EDGES,
+	RANGE_FACES,
+	RANGE_ELEMS
+};
+
+// Evaluate the range of the values that are currently stored in a state.
+// If bsel is true, only selected items contribute. The average is over the items,
+// without weighting by face area or element volume. The mesh holds the geometry of
+// the current state only, so it cannot provide weights for the other states.
+FIELD_RANGE EvalNodeRange(Post::FEPostModel& fem, int nstate, bool bsel);
+FIELD_RANGE EvalEdgeRange(Post::FEPostModel& fem, int nstate, bool bsel);
+FIELD_RANGE EvalFaceRange(Post::FEPostModel& fem, int nstate, bool bsel);
+FIELD_RANGE EvalElemRange(Post::FEPostModel& fem, int nstate, bool bsel);
+
+//-----------------------------------------------------------------------------
+// Caches the range of data fields per state. Evaluating a field for a state is
+// expensive, so the ranges are kept until the model data changes, which makes
+// global (all-state) ranges instantaneous after the first request. Ranges over
+// the selected items are cached as well, until the selection changes.
+class CFieldStats
+{
+public:
+	CFieldStats();
+
+	// clear all cached ranges (call this when the model data changes)
+	void Clear();
+
+	// clear the cached ranges over the selection (call this when the selection changes)
+	void ClearSelection();
+
+	// get the range of a field over the items of a state
+	// (nitem < 0 uses the items the field is defined on)
+	// If bsel is true, only the selected items are considered.
+	FIELD_RANGE GetRange(Post::CGLModel& mdl, int nfield, int nstate, int nitem = -1, bool bsel = false);
+
+	// get the range of a field over all states.
+	// Returns false if the evaluation was cancelled.
+	bool GetGlobalRange(Post::CGLModel& mdl, int nfield, float& fmin, float& fmax, int nitem = -1, CTaskProgress* progress = nullptr);
+
+private:
+	FIELD_RANGE Evaluate(Post::CGLModel& mdl, int nfield, int nstate, int nitem, bool bsel);
+
+private:
+	// ranges keyed by (selection only, field, item, state)
+	std::map<std::tuple<bool, int, int, int>, FIELD_RANGE>	m_range;
+};
@@ -33,6 +33,7 @@ SOFTWARE.*/
 
 #include "MainWindow.h"
 #include "Document.h"
+#include "BackgroundTask.h"
 #include <GLWLib/GLWidget.h>
 #include <QBitmap>
 #include <PostGL/GLModel.h>
@@ -554,6 +555,9 @@ void CGLView::setupProjectionMatrix()
 
 void CGLView::paintGL()
 {
+	// a background task may be working on the model, so keep the last frame until it is done
+	if (IsBackgroundTaskRunning()) return;
+
 	// clear the Graphics view
 	// This renders the background
 	Clear();
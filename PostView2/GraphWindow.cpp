@@ -52,8 +52,16 @@ SOFTWARE.*/
 #include <MathLib/LinearRegression.h>
 #include "CColorButton.h"
 #include <GLWLib/convert.h>
+#include "ParallelFor.h"
+#include "PlotExport.h"
+#include "BackgroundTask.h"
+#include <algorithm>
 using namespace Post;
 
+// When more items are selected than this, line plots show the envelope of 
+// the curves instead of the individual curves (if the option is enabled)
+const int MAX_ENVELOPE_CURVES = 50;
+
 OptionsUi::OptionsUi(CGraphWidget* graph, QWidget* parent) : CPlotTool(parent)
 {
 	QVBoxLayout* l = new QVBoxLayout;
@@ -64,12 +72,22 @@ OptionsUi::OptionsUi(CGraphWidget* graph, QWidget* parent) : CPlotTool(parent)
 	l->addWidget(smoothLines = new QCheckBox("Smooth lines"));
 	l->addWidget(dataMarks   = new QCheckBox("Show data marks"));
 	l->addWidget(autoRange   = new QCheckBox("auto update plot range"));
+	l->addWidget(envelope    = new QCheckBox(QString("Envelope for more than %1 curves").arg(MAX_ENVELOPE_CURVES)));
+
+	QHBoxLayout* hq = new QHBoxLayout;
+	hq->addWidget(new QLabel("Band:"));
+	hq->addWidget(quantiles = new QComboBox);
+	quantiles->addItem("5% - 95%");
+	quantiles->addItem("10% - 90%");
+	quantiles->addItem("25% - 75%");
+	l->addLayout(hq);
 	l->addStretch();
 	setLayout(l);
 
 	smoothLines->setChecked(true);
 	dataMarks->setChecked(true);
 	autoRange->setChecked(true);
+	envelope->setChecked(true);
 
 	timeOption[0]->setChecked(true);
 
@@ -80,6 +98,8 @@ OptionsUi::OptionsUi(CGraphWidget* graph, QWidget* parent) : CPlotTool(parent)
 	QObject::connect(smoothLines  , SIGNAL(stateChanged(int)), SLOT(onOptionsChanged()));
 	QObject::connect(dataMarks    , SIGNAL(stateChanged(int)), SLOT(onOptionsChanged()));
 	QObject::connect(autoRange  ,   SIGNAL(stateChanged(int)), SLOT(onOptionsChanged()));
+	QObject::connect(envelope   ,   SIGNAL(stateChanged(int)), SLOT(onOptionsChanged()));
+	QObject::connect(quantiles  ,   SIGNAL(currentIndexChanged(int)), SLOT(onOptionsChanged()));
 }
 
 void OptionsUi::onOptionsChanged()
@@ -110,6 +130,22 @@ bool OptionsUi::autoRangeUpdate()
 	return autoRange->isChecked();
 }
 
+bool OptionsUi::showEnvelope()
+{
+	return envelope->isChecked();
+}
+
+double OptionsUi::envelopeQuantile()
+{
+	switch (quantiles->currentIndex())
+	{
+	case 0: return 0.05;
+	case 1: return 0.10;
+	case 2: return 0.25;
+	}
+	return 0.05;
+}
+
 void OptionsUi::setUserTimeRange(int imin, int imax)
 {
 	timeRange->setText(QString("%1:%2").arg(imin).arg(imax));
@@ -583,6 +619,9 @@ CGraphWindow::CGraphWindow(CMainWindow* pwnd, int flags) : m_wnd(pwnd), QMainWin
 	m_nUserMin = 0;
 	m_nUserMax = -1;
 
+	m_bshowEnvelope = true;
+	m_quantile = 0.05;
+
 	// delete the window when it's closed
 	setAttribute(Qt::WA_DeleteOnClose);
 
@@ -634,6 +673,18 @@ void CGraphWindow::GetUserTimeRange(int& minTime, int& maxTime)
 	maxTime = m_nUserMax;
 }
 
+//-----------------------------------------------------------------------------
+bool CGraphWindow::ShowEnvelope()
+{
+	return m_bshowEnvelope;
+}
+
+//-----------------------------------------------------------------------------
+double CGraphWindow::GetEnvelopeQuantile()
+{
+	return m_quantile;
+}
+
 //-----------------------------------------------------------------------------
 void CGraphWindow::GetTimeRange(int& minTime, int& maxTime)
 {
@@ -804,10 +855,38 @@ void CGraphWindow::on_selectPlot_currentIndexChanged(int index)
 //-----------------------------------------------------------------------------
 void CGraphWindow::on_actionSave_triggered()
 {
-	QString fileName = QFileDialog::getSaveFileName(this, "Save Graph Data", QDir::currentPath(), QString("All files (*)"));
+	QStringList filters;
+	filters << "Text file (*.txt)";
+	filters << "CSV, one column per series (*.csv)";
+	filters << "CSV, one row per point (*.csv)";
+	filters << "Binary columnar (*.bin)";
+	filters << "All files (*)";
+
+	QString filter;
+	QString fileName = QFileDialog::getSaveFileName(this, "Save Graph Data", QDir::currentPath(), filters.join(";;"), &filter);
 	if (fileName.isEmpty() == false)
 	{
-		if (ui->plot->Save(fileName) == false)
+		int format = EXPORT_TEXT;
+		switch (filters.indexOf(filter))
+		{
+		case 1: format = EXPORT_CSV_WIDE; break;
+		case 2: format = EXPORT_CSV_LONG; break;
+		case 3: format = EXPORT_BINARY; break;
+		}
+
+		// Large graphs can take a while, so we write the file in the background.
+		// The graph can be updated in the meantime, so the data is copied first.
+		PLOT_EXPORT_DATA data;
+		GetPlotExportData(*ui->plot, data);
+
+		bool bret = false;
+		CTaskProgress progress;
+		std::string sfile = fileName.toStdString();
+		bool bdone = RunBackgroundTask(this, "Saving graph data ...", progress, [&]() {
+			bret = ExportPlotData(data, sfile, format, &progress);
+		});
+
+		if (bdone && (bret == false))
 			QMessageBox::critical(this, "Save Graph Data", "A problem occurred saving the data.");
 	}
 }
@@ -882,6 +961,9 @@ void CGraphWindow::on_options_optionsChanged()
 	bool autoRng = ui->ops->autoRangeUpdate();
 	ui->plot->setAutoRangeUpdate(autoRng);
 
+	m_bshowEnvelope = ui->ops->showEnvelope();
+	m_quantile = ui->ops->envelopeQuantile();
+
 	Update(false);
 }
 
@@ -893,11 +975,25 @@ CDataGraphWindow::CDataGraphWindow(CMainWindow* wnd) : CGraphWindow(wnd)
 
 void CDataGraphWindow::SetData(const std::vector<double>& data, QString title)
 {
-	m_title = title;
+	m_title.clear();
+	m_data.clear();
+	AddData(data, title);
+}
+
+void CDataGraphWindow::SetData(const std::vector< std::vector<double> >& data, const QStringList& titles)
+{
+	m_title = titles;
 	m_data = data;
 	Update(true, true);
 }
 
+void CDataGraphWindow::AddData(const std::vector<double>& data, QString title)
+{
+	m_title.push_back(title);
+	m_data.push_back(data);
+	Update(true, true);
+}
+
 void CDataGraphWindow::Update(bool breset, bool bfit)
 {
 	ClearPlots();
@@ -906,16 +1002,21 @@ void CDataGraphWindow::Update(bool breset, bool bfit)
 	{
 		FEPostModel* fem = doc->GetFEModel();
 		int nsteps = fem->GetStates();
-		CLineChartData* plot = new CLineChartData;
-		for (int j = 0; j < nsteps; ++j)
+		for (int i = 0; i < (int)m_data.size(); ++i)
 		{
-			FEState* ps = fem->GetState(j);
-			double yj = 0.0;
-			if (j < m_data.size()) yj = m_data[j];
-			plot->addPoint(ps->m_time, yj);
+			const std::vector<double>& data = m_data[i];
+			CLineChartData* plot = new CLineChartData;
+			for (int j = 0; j < nsteps; ++j)
+			{
+				FEState* ps = fem->GetState(j);
+				double yj = 0.0;
+				if (j < data.size()) yj = data[j];
+				if (qIsNaN(yj)) continue;
+				plot->addPoint(ps->m_time, yj);
+			}
+			if (i < m_title.size()) plot->setLabel(m_title[i]);
+			AddPlotData(plot);
 		}
-		plot->setLabel(m_title);
-		AddPlotData(plot);
 		FitPlotsToData();
 	}
 	UpdatePlots();
@@ -933,6 +1034,9 @@ CModelGraphWindow::CModelGraphWindow(CMainWindow* wnd) : CGraphWindow(wnd)
 	m_dataYPrev = -1;
 
 	m_xtype = m_xtypeprev = -1;
+	m_envelope = m_envelopePrev = -1.0;
+
+	m_selCount[0] = m_selCount[1] = m_selCount[2] = m_selCount[3] = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -996,10 +1100,22 @@ void CModelGraphWindow::Update(bool breset, bool bfit)
 		return;
 	}
 
+	// Collect the selection again, since not every selection change calls Update
+	// with bfit set (e.g. Select Range or the Find dialog). If it changed, the
+	// graph must be rebuilt.
+	bool bselChanged = updateSelection();
+
+	// see if we should show the envelope instead of the individual curves
+	m_envelope = -1.0;
+	if ((nplotType == LINE_PLOT) && ShowEnvelope() && ((int)m_selItems.size() > MAX_ENVELOPE_CURVES))
+	{
+		m_envelope = GetEnvelopeQuantile();
+	}
+
 	// When a reset is not required, see if we actually need to update anything
 	if ((breset == false) && (bfit == false))
 	{
-		if ((nmin == m_firstState) && (nmax == m_lastState) && (m_dataX == m_dataXPrev) && (m_dataY == m_dataYPrev) && (m_xtype == m_xtypeprev)) return;
+		if ((nmin == m_firstState) && (nmax == m_lastState) && (m_dataX == m_dataXPrev) && (m_dataY == m_dataYPrev) && (m_xtype == m_xtypeprev) && (m_envelope == m_envelopePrev) && (bselChanged == false)) return;
 	}
 
 	// set current time point index (TODO: Not sure if this is still used)
@@ -1026,26 +1142,32 @@ void CModelGraphWindow::Update(bool breset, bool bfit)
 	m_firstState = nmin;
 	m_lastState = nmax;
 
-	// we need to update the displacement map for all time steps
-	// since the strain calculations depend on it
-	int nsteps = doc->GetTimeSteps();
+	// we need to update the displacement map for the time steps that are
+	// graphed since the strain calculations depend on it
 	CGLDisplacementMap* pdm = po->GetDisplacementMap();
 	if (pdm)
 	{
-		for (int i = 0; i<nsteps; ++i) po->GetDisplacementMap()->UpdateState(i);
+		for (int i = nmin; i <= nmax; ++i) pdm->UpdateState(i);
 	}
 
 	// get the graph of the track view and clear it
 	ClearPlots();
 
 	// add selections
-	addSelectedNodes();
-	addSelectedEdges();
-	addSelectedFaces();
-	addSelectedElems();
+	if (m_envelope > 0.0)
+	{
+		addEnvelope();
+	}
+	else
+	{
+		addSelectedNodes();
+		addSelectedEdges();
+		addSelectedFaces();
+		addSelectedElems();
+	}
 
 	// redraw
-	if ((m_dataX != m_dataXPrev) || (m_dataY != m_dataYPrev) || (m_xtype != m_xtypeprev) || bfit)
+	if ((m_dataX != m_dataXPrev) || (m_dataY != m_dataYPrev) || (m_xtype != m_xtypeprev) || (m_envelope != m_envelopePrev) || bfit)
 	{
 		FitPlotsToData();
 	}
@@ -1053,10 +1175,160 @@ void CModelGraphWindow::Update(bool breset, bool bfit)
 	m_dataXPrev = m_dataX;
 	m_dataYPrev = m_dataY;
 	m_xtypeprev = m_xtype;
+	m_envelopePrev = m_envelope;
 
 	UpdatePlots();
 }
 
+//-----------------------------------------------------------------------------
+bool CModelGraphWindow::updateSelection()
+{
+	Post::FEPostMesh& mesh = *GetDocument()->GetFEModel()->GetFEMesh(0);
+
+	vector<int> prevItems;
+	prevItems.swap(m_selItems);
+	int prevCount[4] = { m_selCount[0], m_selCount[1], m_selCount[2], m_selCount[3] };
+
+	for (int i = 0; i < mesh.Nodes(); ++i) if (mesh.Node(i).IsSelected()) m_selItems.push_back(i);
+	m_selCount[0] = (int)m_selItems.size();
+	for (int i = 0; i < mesh.Edges(); ++i) if (mesh.Edge(i).IsSelected()) m_selItems.push_back(i);
+	m_selCount[1] = (int)m_selItems.size() - m_selCount[0];
+	for (int i = 0; i < mesh.Faces(); ++i) if (mesh.Face(i).IsSelected()) m_selItems.push_back(i);
+	m_selCount[2] = (int)m_selItems.size() - m_selCount[0] - m_selCount[1];
+	for (int i = 0; i < mesh.Elements(); ++i) if (mesh.ElementRef(i).IsSelected()) m_selItems.push_back(i);
+	m_selCount[3] = (int)m_selItems.size() - m_selCount[0] - m_selCount[1] - m_selCount[2];
+
+	for (int i = 0; i < 4; ++i) if (m_selCount[i] != prevCount[i]) return true;
+	return (m_selItems != prevItems);
+}
+
+//-----------------------------------------------------------------------------
+// Instead of a curve for each selected item, this shows the envelope of all
+// the curves. The values of all items are evaluated into one table, one state
+// at a time, from which the min-max band, a quantile band and the mean are
+// computed for each time step. The items with the lowest, median and highest
+// time-averaged value are drawn as representative curves.
+void CModelGraphWindow::addEnvelope()
+{
+	CDocument* pdoc = GetDocument();
+	FEPostModel& fem = *pdoc->GetFEModel();
+
+	const vector<int>& items = m_selItems;
+	int nitems = (int)items.size();
+	if (nitems == 0) return;
+
+	int nodes = m_selCount[0];
+	int edges = nodes + m_selCount[1];
+	int faces = edges + m_selCount[2];
+
+	vector<QString> labels(nitems);
+	for (int i = 0; i < nitems; ++i)
+	{
+		const char* sz = (i < nodes ? "N" : (i < edges ? "L" : (i < faces ? "F" : "E")));
+		labels[i] = QString("%1%2").arg(sz).arg(items[i] + 1);
+	}
+
+	// Evaluate the values (one row per item). Each state is visited once for all the
+	// items. The item evaluations only read the model, so the states are done in parallel.
+	int nsteps = m_lastState - m_firstState + 1;
+	if ((m_firstState < 0) || (m_lastState >= fem.GetStates()) || (nsteps <= 0)) return;
+	vector<float> hist(nitems*nsteps);
+	int nfield = m_dataY;
+	ParallelFor(nsteps, [&](int j) {
+		int n = j + m_firstState;
+		NODEDATA nd;
+		EDGEDATA ed;
+		float data[FEElement::MAX_NODES] = { 0.f }, val;
+		for (int i = 0; i < nitems; ++i)
+		{
+			float v = 0.f;
+			if      (i < nodes) { fem.EvaluateNode(items[i], n, nfield, nd); v = nd.m_val; }
+			else if (i < edges) { fem.EvaluateEdge(items[i], n, nfield, ed); v = ed.m_val; }
+			else if (i < faces) { fem.EvaluateFace(items[i], n, nfield, data, val); v = val; }
+			else                { fem.EvaluateElement(items[i], n, nfield, data, val); v = val; }
+			hist[i*nsteps + j] = v;
+		}
+	}, 1);
+
+	// x-values
+	vector<double> x(nsteps);
+	for (int j = 0; j < nsteps; ++j)
+	{
+		if (m_xtype == 0) x[j] = fem.GetState(j + m_firstState)->m_time;
+		else x[j] = (double)j + 1.0 + m_firstState;
+	}
+
+	// statistics over all items for each time step
+	double q = m_envelope;
+	int klo = (int)(q*(nitems - 1) + 0.5);
+	int khi = nitems - 1 - klo;
+	vector<double> ymin(nsteps), ymax(nsteps), ymean(nsteps), qlo(nsteps), qhi(nsteps);
+	vector< vector<float> > buf(ParallelThreads(), vector<float>(nitems));
+	ParallelForThread(nsteps, [&](int j, int thread) {
+		vector<float>& col = buf[thread];
+		double sum = 0.0;
+		float vmin = hist[j], vmax = hist[j];
+		for (int i = 0; i < nitems; ++i)
+		{
+			float v = hist[i*nsteps + j];
+			col[i] = v;
+			sum += v;
+			if (v < vmin) vmin = v;
+			if (v > vmax) vmax = v;
+		}
+		ymin[j] = vmin;
+		ymax[j] = vmax;
+		ymean[j] = sum / nitems;
+
+		std::nth_element(col.begin(), col.begin() + klo, col.end());
+		qlo[j] = col[klo];
+		std::nth_element(col.begin() + klo, col.begin() + khi, col.end());
+		qhi[j] = col[khi];
+	});
+
+	// find the representative items
+	vector<pair<double, int> > avg(nitems);
+	for (int i = 0; i < nitems; ++i)
+	{
+		double sum = 0.0;
+		for (int j = 0; j < nsteps; ++j) sum += hist[i*nsteps + j];
+		avg[i] = pair<double, int>(sum / nsteps, i);
+	}
+	std::sort(avg.begin(), avg.end());
+
+	// add the plots
+	CBandChartData* band = new CBandChartData;
+	band->setBand(x, ymin, ymax);
+	band->setLabel("min - max");
+	AddPlotData(band);
+	band->setColor(QColor(70, 130, 180, 60));
+
+	int pct = (int)(100.0*q + 0.5);
+	band = new CBandChartData;
+	band->setBand(x, qlo, qhi);
+	band->setLabel(QString("%1% - %2%").arg(pct).arg(100 - pct));
+	AddPlotData(band);
+	band->setColor(QColor(70, 130, 180, 120));
+
+	CLineChartData* plot = new CLineChartData;
+	plot->setLabel("mean");
+	plot->addPoints(&x[0], &ymean[0], nsteps);
+	AddPlotData(plot);
+	plot->setColor(QColor(0, 0, 139));
+
+	int rep[3] = { avg[0].second, avg[nitems / 2].second, avg[nitems - 1].second };
+	const char* szrep[3] = { "lowest", "median", "highest" };
+	for (int k = 0; k < 3; ++k)
+	{
+		int n = rep[k];
+		plot = new CLineChartData;
+		plot->setLabel(QString("%1 (%2)").arg(labels[n]).arg(szrep[k]));
+		plot->reserve(nsteps);
+		for (int j = 0; j < nsteps; ++j) plot->addPoint(x[j], hist[n*nsteps + j]);
+		AddPlotData(plot);
+	}
+}
+
 //-----------------------------------------------------------------------------
 void CModelGraphWindow::addSelectedNodes()
 {
@@ -1086,7 +1358,7 @@ void CModelGraphWindow::addSelectedNodes()
 
 				CLineChartData* plot = new CLineChartData;
 				plot->setLabel(QString("N%1").arg(i + 1));
-				for (int j = 0; j<nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
+				plot->addPoints(&xdata[0], &ydata[0], nsteps);
 				AddPlotData(plot);
 			}
 		}
@@ -1106,7 +1378,7 @@ void CModelGraphWindow::addSelectedNodes()
 
 				CLineChartData* plot = new CLineChartData;
 				plot->setLabel(QString("N%1").arg(i + 1));
-				for (int j = 0; j<nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
+				plot->addPoints(&xdata[0], &ydata[0], nsteps);
 				AddPlotData(plot);
 			}
 		}
@@ -1126,7 +1398,7 @@ void CModelGraphWindow::addSelectedNodes()
 
 				CLineChartData* plot = new CLineChartData;
 				plot->setLabel(QString("N%1").arg(i + 1));
-				for (int j = 0; j<nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
+				plot->addPoints(&xdata[0], &ydata[0], nsteps);
 				AddPlotData(plot);
 			}
 		}
@@ -1143,41 +1415,26 @@ void CModelGraphWindow::addSelectedNodes()
 
 		if (sel.empty() == false)
 		{
-			int nsteps = m_lastState - m_firstState + 1;
-			if (nsteps > 32) nsteps = 32;
-			for (int i = m_firstState; i < m_firstState + nsteps; ++i)
-			{
-				CLineChartData* plot = new CLineChartData;
-				plot->setLabel(QString("%1").arg(fem.GetState(i)->m_time));
-				AddPlotData(plot);
-			}
+			CColorScatterData* plot = new CColorScatterData;
+			plot->reserve(nsteps*(int)sel.size());
+
+			// the points are colored by time
+			vector<float> tdata(nsteps);
+			for (int j = 0; j < nsteps; ++j) tdata[j] = fem.GetState(j + m_firstState)->m_time;
+			plot->setLabel(QString("time %1 - %2").arg(tdata[0]).arg(tdata[nsteps - 1]));
 
 			for (int i = 0; i < (int)sel.size(); i++)
 			{
-				FENode& node = mesh.Node(sel[i]);
-				if (node.IsSelected())
-				{
-					// evaluate x-field
-					TrackNodeHistory(sel[i], &xdata[0], m_dataX, m_firstState, m_firstState + nsteps - 1);
-
-					// evaluate y-field
-					TrackNodeHistory(sel[i], &ydata[0], m_dataY, m_firstState, m_firstState + nsteps - 1);
-
-					for (int j = 0; j < nsteps; ++j)
-					{
-						CPlotData& p = GetPlotWidget()->getPlotData(j);
-						p.addPoint(xdata[j], ydata[j]);
-					}
-				}
-			}
+				// evaluate x-field
+				TrackNodeHistory(sel[i], &xdata[0], m_dataX, m_firstState, m_lastState);
 
-			// sort the plots 
-			int nplots = GetPlotWidget()->plots();
-			for (int i = 0; i < nplots; ++i)
-			{
-				CPlotData& data = GetPlotWidget()->getPlotData(i);
-				data.sort();
+				// evaluate y-field
+				TrackNodeHistory(sel[i], &ydata[0], m_dataY, m_firstState, m_lastState);
+
+				plot->addPoints(&xdata[0], &ydata[0], &tdata[0], nsteps);
 			}
+
+			AddPlotData(plot);
 		}
 	}
 	break;
@@ -1220,7 +1477,7 @@ void CModelGraphWindow::addSelectedEdges()
 
 			CLineChartData* plot = new CLineChartData;
 			plot->setLabel(QString("L%1").arg(i + 1));
-			for (int j = 0; j<nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
+			plot->addPoints(&xdata[0], &ydata[0], nsteps);
 			AddPlotData(plot);
 		}
 	}
@@ -1255,7 +1512,7 @@ void CModelGraphWindow::addSelectedFaces()
 
 				CLineChartData * plot = new CLineChartData;
 				plot->setLabel(QString("F%1").arg(i + 1));
-				for (int j = 0; j < nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
+				plot->addPoints(&xdata[0], &ydata[0], nsteps);
 				AddPlotData(plot);
 			}
 		}
@@ -1273,7 +1530,7 @@ void CModelGraphWindow::addSelectedFaces()
 
 				CLineChartData* plot = new CLineChartData;
 				plot->setLabel(QString("F%1").arg(i + 1));
-				for (int j = 0; j < nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
+				plot->addPoints(&xdata[0], &ydata[0], nsteps);
 				AddPlotData(plot);
 			}
 		}
@@ -1292,7 +1549,7 @@ void CModelGraphWindow::addSelectedFaces()
 
 				CLineChartData* plot = new CLineChartData;
 				plot->setLabel(QString("F%1").arg(i + 1));
-				for (int j = 0; j < nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
+				plot->addPoints(&xdata[0], &ydata[0], nsteps);
 				AddPlotData(plot);
 			}
 		}
@@ -1308,41 +1565,28 @@ void CModelGraphWindow::addSelectedFaces()
 
 		if (sel.empty() == false)
 		{
-			int nsteps = m_lastState - m_firstState + 1;
-			if (nsteps > 32) nsteps = 32;
-			for (int i = m_firstState; i < m_firstState + nsteps; ++i)
-			{
-				CLineChartData* plot = new CLineChartData;
-				plot->setLabel(QString("%1").arg(fem.GetState(i)->m_time));
-				AddPlotData(plot);
-			}
+			CColorScatterData* plot = new CColorScatterData;
+			plot->reserve(nsteps*(int)sel.size());
+
+			// the points are colored by time
+			vector<float> tdata(nsteps);
+			for (int j = 0; j < nsteps; ++j) tdata[j] = fem.GetState(j + m_firstState)->m_time;
+			plot->setLabel(QString("time %1 - %2").arg(tdata[0]).arg(tdata[nsteps - 1]));
 
 			for (int i = 0; i < (int)sel.size(); i++)
 			{
-				FEFace& face = mesh.Face(sel[i]);
-
 				// evaluate x-field
 				TrackFaceHistory(sel[i], &xdata[0], m_dataX, m_firstState, m_lastState);
 
 				// evaluate y-field
 				TrackFaceHistory(sel[i], &ydata[0], m_dataY, m_firstState, m_lastState);
 
-				for (int j = 0; j < nsteps; ++j)
-				{
-					CPlotData& p = GetPlotWidget()->getPlotData(j);
-					p.addPoint(xdata[j], ydata[j]);
-				}
+				plot->addPoints(&xdata[0], &ydata[0], &tdata[0], nsteps);
 			}
 
-			// sort the plots 
-			CPlotWidget* w = GetPlotWidget();
-			int nplots = w->plots();
-			for (int i = 0; i < nplots; ++i)
-			{
-				CPlotData& data = GetPlotWidget()->getPlotData(i);
-				data.sort();
-			}
+			AddPlotData(plot);
 
+			CPlotWidget* w = GetPlotWidget();
 			if (w->autoRangeUpdate())
 				w->fitToData(false);
 		}
@@ -1379,7 +1623,7 @@ void CModelGraphWindow::addSelectedElems()
 				TrackElementHistory(i, &ydata[0], m_dataY, m_firstState, m_lastState);
 
 				CLineChartData* plot = new CLineChartData;
-				for (int j = 0; j < nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
+				plot->addPoints(&xdata[0], &ydata[0], nsteps);
 				plot->setLabel(QString("E%1").arg(i + 1));
 				AddPlotData(plot);
 			}
@@ -1398,7 +1642,7 @@ void CModelGraphWindow::addSelectedElems()
 				TrackElementHistory(i, &ydata[0], m_dataY, m_firstState, m_lastState);
 
 				CLineChartData* plot = new CLineChartData;
-				for (int j = 0; j < nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
+				plot->addPoints(&xdata[0], &ydata[0], nsteps);
 				plot->setLabel(QString("E%1").arg(i + 1));
 				AddPlotData(plot);
 			}
@@ -1417,7 +1661,7 @@ void CModelGraphWindow::addSelectedElems()
 				TrackElementHistory(i, &ydata[0], m_dataY, m_firstState, m_lastState);
 
 				CLineChartData* plot = new CLineChartData;
-				for (int j = 0; j < nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
+				plot->addPoints(&xdata[0], &ydata[0], nsteps);
 				plot->setLabel(QString("E%1").arg(i + 1));
 				AddPlotData(plot);
 			}
@@ -1434,43 +1678,28 @@ void CModelGraphWindow::addSelectedElems()
 
 		if (sel.empty() == false)
 		{
-			int nsteps = m_lastState - m_firstState + 1;
-			if (nsteps > 32) nsteps = 32;
-			for (int i = m_firstState; i < m_firstState + nsteps; ++i)
-			{
-				CLineChartData* plot = new CLineChartData;
-				plot->setLabel(QString("%1").arg(fem.GetState(i)->m_time));
-				AddPlotData(plot);
-			}
+			CColorScatterData* plot = new CColorScatterData;
+			plot->reserve(nsteps*(int)sel.size());
+
+			// the points are colored by time
+			vector<float> tdata(nsteps);
+			for (int j = 0; j < nsteps; ++j) tdata[j] = fem.GetState(j + m_firstState)->m_time;
+			plot->setLabel(QString("time %1 - %2").arg(tdata[0]).arg(tdata[nsteps - 1]));
 
 			for (int i = 0; i < (int)sel.size(); i++)
 			{
-				FEElement_& e = mesh.ElementRef(sel[i]);
-				if (e.IsSelected())
-				{
-					// evaluate x-field
-					TrackElementHistory(sel[i], &xdata[0], m_dataX, m_firstState, m_lastState);
-
-					// evaluate y-field
-					TrackElementHistory(sel[i], &ydata[0], m_dataY, m_firstState, m_lastState);
-
-					for (int j = 0; j < nsteps; ++j)
-					{
-						CPlotData& p = GetPlotWidget()->getPlotData(j);
-						p.addPoint(xdata[j], ydata[j]);
-					}
-				}
-			}
+				// evaluate x-field
+				TrackElementHistory(sel[i], &xdata[0], m_dataX, m_firstState, m_lastState);
 
-			// sort the plots 
-			CPlotWidget* w = GetPlotWidget();
-			int nplots = w->plots();
-			for (int i = 0; i < nplots; ++i)
-			{
-				CPlotData& data = GetPlotWidget()->getPlotData(i);
-				data.sort();
+				// evaluate y-field
+				TrackElementHistory(sel[i], &ydata[0], m_dataY, m_firstState, m_lastState);
+
+				plot->addPoints(&xdata[0], &ydata[0], &tdata[0], nsteps);
 			}
 
+			AddPlotData(plot);
+
+			CPlotWidget* w = GetPlotWidget();
 			if (w->autoRangeUpdate())
 				w->fitToData(false);
 		}
@@ -26,6 +26,7 @@ SOFTWARE.*/
 
 #pragma once
 #include <QMainWindow>
+#include <QStringList>
 #include <MathLib/MathParser.h>
 #include "PlotWidget.h"
 #include "Document.h"
@@ -68,6 +69,8 @@ public:
 	QCheckBox*		smoothLines;
 	QCheckBox*		dataMarks;
 	QCheckBox*		autoRange;
+	QCheckBox*		envelope;
+	QComboBox*		quantiles;
 
 public:
 	int currentOption();
@@ -80,6 +83,10 @@ public:
 
 	bool autoRangeUpdate();
 
+	bool showEnvelope();
+
+	double envelopeQuantile();
+
 public slots:
 	void onOptionsChanged();
 
@@ -216,6 +223,10 @@ public:
 	void GetUserTimeRange(int& userMin, int& userMax);
 	void GetTimeRange(int& minTime, int& maxTime);
 
+	// envelope options
+	bool ShowEnvelope();
+	double GetEnvelopeQuantile();
+
 public: // convenience functions for modifying the plot widget
 
 	// clear all plots
@@ -283,6 +294,9 @@ private:
 
 	int		m_nTrackTime;
 	int		m_nUserMin, m_nUserMax;	//!< manual time step range
+
+	bool	m_bshowEnvelope;	//!< show the envelope of large selections
+	double	m_quantile;			//!< lower quantile of the envelope band
 };
 
 //=================================================================================================
@@ -293,11 +307,17 @@ public:
 
 	void SetData(const std::vector<double>& data, QString title);
 
+	// set several series at once (the graph is only updated once)
+	void SetData(const std::vector< std::vector<double> >& data, const QStringList& titles);
+
+	// add another series to the graph (states with a NaN value are not plotted)
+	void AddData(const std::vector<double>& data, QString title);
+
 	void Update(bool breset = true, bool bfit = false);
 
 private:
-	QString				m_title;
-	std::vector<double>	m_data;
+	QStringList							m_title;
+	std::vector< std::vector<double> >	m_data;
 };
 
 //=================================================================================================
@@ -322,10 +342,22 @@ private:
 	void addSelectedFaces();
 	void addSelectedElems();
 
+	// add the envelope of all selected items
+	void addEnvelope();
+
+	// collect the selected items (see m_selItems) and return true if they changed
+	bool updateSelection();
+
 private: // temporary variables used during update
 	int	m_xtype, m_xtypeprev;			// x-plot field option (0=time, 1=steps, 2=data field)
 	int	m_firstState, m_lastState;		// first and last time step to be evaluated
 	int	m_dataX, m_dataY;				// X and Y data field IDs
 	int	m_dataXPrev, m_dataYPrev;		// Previous X, Y data fields
+	double	m_envelope, m_envelopePrev;	// quantile of envelope (or -1 if not shown)
+
+	// The selected nodes, edges, faces and elements (in that order). This is collected
+	// once per update and shared by the functions that add the curves.
+	std::vector<int>	m_selItems;
+	int					m_selCount[4];	// number of selected nodes, edges, faces and elements
 };
 
@@ -30,6 +30,8 @@ SOFTWARE.*/
 #include "Document.h"
 #include "PlotWidget.h"
 #include "DataFieldSelector.h"
+#include "ParallelFor.h"
+#include "BackgroundTask.h"
 #include <QComboBox>
 #include <QToolBar>
 #include <QLabel>
@@ -50,6 +52,11 @@ CIntegrateWindow::CIntegrateWindow(CMainWindow* wnd) : CGraphWindow(wnd, 0)
 	if (doc) title += " - " + QString::fromStdString(doc->GetFileName());
 	setWindowTitle(title);
 	m_nsrc = -1;
+	m_updating = false;
+	m_cacheRev = 0;
+	m_cacheTick = 0;
+	m_cacheDisp = -1;
+	m_cacheScale = 0.f;
 }
 
 void CIntegrateWindow::Update(bool breset, bool bfit)
@@ -57,6 +64,12 @@ void CIntegrateWindow::Update(bool breset, bool bfit)
 	CDocument* doc = GetDocument();
 	if (doc->IsValid() == false) return;
 
+	// the integration pumps the event loop, so don't allow re-entry
+	if (m_updating) return;
+
+	// a reset means the model data may have changed
+	if (breset) m_cache.clear();
+
 	// update the source options
 	m_updating = true;
 	if (breset || (m_nsrc == -1)) UpdateSourceOptions();
@@ -139,6 +152,23 @@ void CIntegrateWindow::UpdateSourceOptions()
 }
 
 //-----------------------------------------------------------------------------
+// Collects the indices of the selected items in increasing order
+void CIntegrateWindow::GetSelectedItems(Post::FEPostMesh& mesh, int nmode, std::vector<int>& items)
+{
+	items.clear();
+	switch (nmode)
+	{
+	case SELECT_NODES: for (int i = 0; i < mesh.Nodes(); ++i) if (mesh.Node(i).IsSelected()) items.push_back(i); break;
+	case SELECT_EDGES: for (int i = 0; i < mesh.Edges(); ++i) if (mesh.Edge(i).IsSelected()) items.push_back(i); break;
+	case SELECT_FACES: for (int i = 0; i < mesh.Faces(); ++i) if (mesh.Face(i).IsSelected()) items.push_back(i); break;
+	case SELECT_ELEMS: for (int i = 0; i < mesh.Elements(); ++i) if (mesh.ElementRef(i).IsSelected()) items.push_back(i); break;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// The integrals are cached per field, selection and state, so only states that
+// were not integrated before for the current selection are evaluated. Those
+// are integrated concurrently on a background job that can be cancelled.
 void CIntegrateWindow::IntegrateSelection(CLineChartData& data)
 {
 	// get the document
@@ -157,24 +187,100 @@ void CIntegrateWindow::IntegrateSelection(CLineChartData& data)
 	{
 		// get the number of time steps
 		int ntime = pdoc->GetTimeSteps();
+		int nfield = pdoc->GetEvalField();
+
+		// The integrals depend on the model data and, through the nodal positions, on the
+		// displacement map. If either changed since the cache was built, it is cleared.
+		CGLDisplacementMap* pdm = po->GetDisplacementMap();
+		int ndisp = ((pdm && pdm->IsActive()) ? fem.GetDisplacementField() : -1);
+		float scale = (pdm ? pdm->GetScale() : 0.f);
+		if ((pdoc->GetDataRevision() != m_cacheRev) || (ndisp != m_cacheDisp) || (scale != m_cacheScale))
+		{
+			m_cache.clear();
+			m_cacheRev = pdoc->GetDataRevision();
+			m_cacheDisp = ndisp;
+			m_cacheScale = scale;
+		}
+
+		// find the cached values of this selection
+		CacheKey key;
+		key.nfield = nfield;
+		key.nmode = nview;
+		GetSelectedItems(mesh, nview, key.items);
+		auto it = m_cache.find(key);
+		if (it == m_cache.end())
+		{
+			// make room by dropping the entry that wasn't used for the longest time
+			if (m_cache.size() >= 32)
+			{
+				auto lru = m_cache.begin();
+				for (auto jt = m_cache.begin(); jt != m_cache.end(); ++jt)
+				{
+					if (jt->second.ntick < lru->second.ntick) lru = jt;
+				}
+				m_cache.erase(lru);
+			}
+			it = m_cache.insert(std::make_pair(std::move(key), CacheValue())).first;
+		}
+		CacheValue& cache = it->second;
+		cache.ntick = ++m_cacheTick;
+		if ((int)cache.val.size() != ntime)
+		{
+			cache.val.assign(ntime, 0.0);
+			cache.valid.assign(ntime, false);
+		}
+
+		// find the states that still need to be integrated
+		vector<int> states;
+		for (int i = 0; i < ntime; ++i) if (cache.valid[i] == false) states.push_back(i);
 
-		// make sure all states are up-to-date
-		pdoc->UpdateAllStates();
+		if (states.empty() == false)
+		{
+			int nstates = (int)states.size();
+			vector<double> res(nstates, 0.0);
+			vector<char> done(nstates, 0);
+
+			CTaskProgress progress(2 * nstates);
+			RunBackgroundTask(this, "Integrating ...", progress, [&]() {
+
+				// make sure the states are up-to-date
+				for (int i = 0; i < nstates; ++i)
+				{
+					if (progress.IsCancelled()) return;
+					if (pdm) pdm->UpdateState(states[i]);
+					fem.Evaluate(nfield, states[i]);
+					progress.Increment();
+				}
+
+				// evaluate sum/integration
+				ParallelFor(nstates, [&](int i) {
+					if (progress.IsCancelled()) return;
+					FEState* ps = fem.GetState(states[i]);
+					if      (nview == SELECT_NODES) res[i] = IntegrateNodes(mesh, ps);
+					else if (nview == SELECT_EDGES) res[i] = IntegrateEdges(mesh, ps);
+					else if (nview == SELECT_FACES) res[i] = IntegrateFaces(mesh, ps);
+					else if (nview == SELECT_ELEMS) res[i] = IntegrateElems(mesh, ps);
+					else assert(false);
+					done[i] = 1;
+					progress.Increment();
+				}, 1);
+			});
+
+			// keep what was completed, even if the job was cancelled
+			for (int i = 0; i < nstates; ++i)
+			{
+				if (done[i])
+				{
+					cache.val[states[i]] = res[i];
+					cache.valid[states[i]] = true;
+				}
+			}
+		}
 
 		// loop over all steps
 		for (int i=0; i<ntime; ++i)
 		{
-			FEState* ps = fem.GetState(i);
-
-			// evaluate sum/integration
-			double res = 0.0;
-			if      (nview == SELECT_NODES) res = IntegrateNodes(mesh, ps);
-			else if (nview == SELECT_EDGES) res = IntegrateEdges(mesh, ps);
-			else if (nview == SELECT_FACES) res = IntegrateFaces(mesh, ps);
-			else if (nview == SELECT_ELEMS) res = IntegrateElems(mesh, ps);
-			else assert(false);
-
-			data.addPoint(ps->m_time, res);
+			if (cache.valid[i]) data.addPoint(fem.GetState(i)->m_time, cache.val[i]);
 		}
 	}
 }
@@ -194,15 +300,35 @@ void CIntegrateWindow::IntegratePlaneCut(CGLPlaneCutPlot* pp, CLineChartData& da
 	{
 		// get the number of time steps
 		int ntime = pdoc->GetTimeSteps();
-
-		// make sure all states are up-to-date
-		pdoc->UpdateAllStates();
+		int nfield = pdoc->GetEvalField();
+
+		CGLDisplacementMap* pdm = po->GetDisplacementMap();
+
+		// The plane cut builds its slice in the plot object, so the states are
+		// processed one after another, but on the background job so it can be cancelled.
+		vector<double> res(ntime, 0.0);
+		int ndone = 0;
+		CTaskProgress progress(ntime);
+		RunBackgroundTask(this, "Integrating ...", progress, [&]() {
+			for (int i = 0; i < ntime; ++i)
+			{
+				if (progress.IsCancelled()) return;
+
+				// make sure the state is up-to-date
+				if (pdm) pdm->UpdateState(i);
+				fem.Evaluate(nfield, i);
+
+				res[i] = pp->Integrate(fem.GetState(i));
+				ndone++;
+				progress.Increment();
+			}
+		});
 
 		// loop over all steps
-		for (int i=0; i<ntime; ++i)
+		for (int i=0; i<ndone; ++i)
 		{
 			FEState* ps = fem.GetState(i);
-			data.addPoint(ps->m_time, pp->Integrate(ps));
+			data.addPoint(ps->m_time, res[i]);
 		}
 	}
 }
@@ -27,6 +27,7 @@ SOFTWARE.*/
 #pragma once
 #include <QMainWindow>
 #include <vector>
+#include <map>
 #include "Document.h"
 #include "GraphWindow.h"
 
@@ -44,6 +45,29 @@ class CIntegrateWindow : public CGraphWindow
 {
 	Q_OBJECT
 
+	// identifies a cached integral of the current selection
+	struct CacheKey
+	{
+		int					nfield;		// data field that was integrated
+		int					nmode;		// selection mode
+		std::vector<int>	items;		// sorted indices of the selected items
+
+		bool operator < (const CacheKey& k) const
+		{
+			if (nfield != k.nfield) return (nfield < k.nfield);
+			if (nmode  != k.nmode ) return (nmode  < k.nmode );
+			return (items < k.items);
+		}
+	};
+
+	// integral values per state
+	struct CacheValue
+	{
+		std::vector<double>	val;
+		std::vector<bool>	valid;
+		unsigned			ntick;	// when the entry was last used
+	};
+
 public:
 	CIntegrateWindow(CMainWindow* wnd);
 
@@ -56,7 +80,16 @@ private:
 	void IntegrateSelection(CLineChartData& data);
 	void IntegratePlaneCut(Post::CGLPlaneCutPlot* pp, CLineChartData& data);
 
+	// indices of the items selected in the given selection mode
+	void GetSelectedItems(Post::FEPostMesh& mesh, int nmode, std::vector<int>& items);
+
 private:
+	std::map<CacheKey, CacheValue>	m_cache;
+	unsigned int	m_cacheTick;	// incremented each time a cache entry is used
+	unsigned int	m_cacheRev;		// data revision of the document the cache was built for
+	int				m_cacheDisp;	// displacement field the cache was built for (-1 if none)
+	float			m_cacheScale;	// displacement scale the cache was built for
+
 	std::vector<Post::CGLPlaneCutPlot*>	m_src;
 	int		m_nsrc;
 	bool	m_updating;
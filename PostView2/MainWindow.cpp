@@ -35,6 +35,7 @@ SOFTWARE.*/
 #include <QtCore/QMimeData>
 #include "DocManager.h"
 #include "Document.h"
+#include "BackgroundTask.h"
 #include <PostGL/GLModel.h>
 #include <XPLTLib/xpltFileReader.h>
 #include <PostLib/FEFEBioExport.h>
@@ -437,6 +438,9 @@ void CMainWindow::AddGraph(CGraphWindow* graph)
 
 void CMainWindow::UpdateGraphs(bool breset, bool bfit)
 {
+	// the graphs read the model, which a background task may be working on
+	if (IsBackgroundTaskRunning()) return;
+
 	if (ui->graphList.isEmpty() == false)
 	{
 		QList<CGraphWindow*>::iterator it;
@@ -1147,6 +1151,7 @@ void CMainWindow::on_actionHideSelected_triggered()
 
 	UpdateStatusMessage();
 	doc->UpdateFEModel();
+	UpdateGraphs(false, true);
 	RedrawGL();
 }
 
@@ -1181,6 +1186,7 @@ void CMainWindow::on_actionInvertSelection_triggered()
 
 	UpdateStatusMessage();
 	doc->UpdateFEModel();
+	UpdateGraphs(false, true);
 	RedrawGL();
 }
 
@@ -1212,6 +1218,7 @@ void CMainWindow::on_actionSelectAll_triggered()
 
 	UpdateStatusMessage();
 	doc->UpdateFEModel();
+	UpdateGraphs(false, true);
 	RedrawGL();
 }
 
@@ -1230,7 +1237,7 @@ void CMainWindow::on_actionSelectRange_triggered()
 	float d[2];
 	pcol->GetRange(d);
 
-	CDlgSelectRange dlg(this);
+	CDlgSelectRange dlg(doc, this);
 	dlg.m_min = d[0];
 	dlg.m_max = d[1];
 
@@ -1262,6 +1269,7 @@ void CMainWindow::on_actionClearSelection_triggered()
 		mdl.ClearSelection(); 
 		UpdateStatusMessage();
 		doc->UpdateFEModel();
+		UpdateGraphs(false, true);
 		RedrawGL();
 	}
 }
@@ -1754,6 +1762,13 @@ void CMainWindow::onTimer()
 {
 	if (ui->m_isAnimating == false) return;
 
+	// don't change the current time while a background task is working on the model
+	if (IsBackgroundTaskRunning())
+	{
+		StopAnimation();
+		return;
+	}
+
 	CDocument* doc = GetActiveDocument();
 	if (doc == nullptr) return;
 	TIMESETTINGS& time = doc->GetTimeSettings();
@@ -2728,6 +2743,18 @@ void CMainWindow::ShowData(const std::vector<double>& data, const QString& label
 	graph->activateWindow();
 }
 
+// show several data series in one graph window
+void CMainWindow::ShowData(const std::vector< std::vector<double> >& data, const QStringList& labels)
+{
+	CDataGraphWindow* graph = new CDataGraphWindow(this);
+	AddGraph(graph);
+
+	graph->SetData(data, labels);
+	graph->show();
+	graph->raise();
+	graph->activateWindow();
+}
+
 void CMainWindow::onAppLoadFile(const QString& fileName)
 {
 	OpenFile(fileName, -1);
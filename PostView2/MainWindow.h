@@ -26,6 +26,7 @@ SOFTWARE.*/
 
 #pragma once
 #include <QMainWindow>
+#include <QStringList>
 #include <QtCore/QBasicTimer>
 #include <QCloseEvent>
 #include "FileThread.h"
@@ -143,6 +144,9 @@ public:
 	// show data in a graph window
 	void ShowData(const std::vector<double>& data, const QString& label);
 
+	// show several data series in one graph window
+	void ShowData(const std::vector< std::vector<double> >& data, const QStringList& labels);
+
 	// remove a graph from the list
 	void RemoveGraph(CGraphWindow* graph);
 
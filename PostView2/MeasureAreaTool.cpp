@@ -29,8 +29,12 @@ SOFTWARE.*/
 #include "Document.h"
 #include <PostLib/FEPostModel.h>
 #include "MainWindow.h"
+#include "ParallelFor.h"
 using namespace Post;
 
+// max number of face areas that are cached (over all states)
+const int MAX_CACHED_AREAS = 4000000;
+
 //-----------------------------------------------------------------------------
 CMeasureAreaTool::Props::Props(CMeasureAreaTool* ptool) : m_ptool(ptool)
 {
@@ -79,6 +83,9 @@ CMeasureAreaTool::CMeasureAreaTool(CMainWindow* wnd) : CBasicTool("Measure Area"
 	m_minFilter = 0.0;
 	m_maxFilter = 0.0;
 	m_allSteps = false;
+
+	m_cacheModel = 0;
+	m_cacheRev = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -104,46 +111,103 @@ void CMeasureAreaTool::OnApply()
 
 		Post::FEPostMesh* currentMesh = ps->GetFEMesh();
 
+		validateCache(doc, selectedFaces);
+
 		if (m_allSteps)
 		{
 			int nstates = fem.GetStates();
 			std::vector<double> area(nstates, 0.0);
-			for (int i = 0; i < nstates; ++i)
-			{
+			ParallelFor(nstates, [&](int i) {
 				FEState* state = fem.GetState(i);
 				if (state->GetFEMesh() == currentMesh)
-					area[i] = getValue(state, selectedFaces);
+					area[i] = getValue(fem, i, selectedFaces);
 				else
-					area[i] = 0.0;
-			}
+					area[i] = qQNaN();	// not plotted
+			}, 1);
 
 			m_area = area[index];
 
 			m_wnd->ShowData(area, "Area");
 		}
-		else m_area = getValue(ps, selectedFaces);
+		else m_area = getValue(fem, index, selectedFaces);
 	}
 	updateUi();
 }
 
-double CMeasureAreaTool::getValue(FEState* state, const std::vector<FEFace*>& selectedFaces)
+//-----------------------------------------------------------------------------
+// clear the cached face areas if the model, its data or the selection changed
+void CMeasureAreaTool::validateCache(CDocument* doc, const std::vector<FEFace*>& selectedFaces)
 {
-	double area = 0.0;
-	int nsel = 0;
+	FEPostModel* fem = doc->GetFEModel();
+	int N = (int)selectedFaces.size();
+	int nstates = fem->GetStates();
+
+	// don't cache large selections
+	if ((double)N*nstates > MAX_CACHED_AREAS)
+	{
+		m_faceArea.clear();
+		m_cacheFaces.clear();
+		return;
+	}
+
+	bool bvalid = (doc->GetModelID() == m_cacheModel) && (doc->GetDataRevision() == m_cacheRev) && (N == (int)m_cacheFaces.size());
+	for (int i = 0; bvalid && (i < N); ++i)
+	{
+		if (selectedFaces[i]->GetID() != m_cacheFaces[i]) bvalid = false;
+	}
+
+	if (bvalid && ((int)m_faceArea.size() == nstates)) return;
+
+	m_cacheModel = doc->GetModelID();
+	m_cacheRev = doc->GetDataRevision();
+	m_cacheFaces.resize(N);
+	for (int i = 0; i < N; ++i) m_cacheFaces[i] = selectedFaces[i]->GetID();
+	m_faceArea.assign(nstates, std::vector<double>());
+}
+
+//-----------------------------------------------------------------------------
+// Returns the areas of the selected faces in the deformed configuration of the state. The areas are
+// calculated the first time they are needed. Each state has its own entry, so different states can
+// be evaluated concurrently. When the cache is not used, the areas are calculated in buf.
+const std::vector<double>& CMeasureAreaTool::faceAreas(FEPostModel& fem, int nstate, const std::vector<FEFace*>& selectedFaces, std::vector<double>& buf)
+{
+	bool bcache = (nstate < (int)m_faceArea.size());
+	std::vector<double>& faceArea = (bcache ? m_faceArea[nstate] : buf);
+	if (bcache && (faceArea.empty() == false)) return faceArea;
+
+	FEState* state = fem.GetState(nstate);
 	Post::FEPostMesh& mesh = *state->GetFEMesh();
 	int N = (int)selectedFaces.size();
+	faceArea.resize(N);
 	vector<vec3d> rt;
 	for (int i = 0; i<N; ++i)
+	{
+		FEFace& f = *selectedFaces[i];
+		int nf = f.Nodes();
+		rt.resize(nf);
+		for (int j = 0; j < nf; ++j) rt[j] = state->m_NODE[f.n[j]].m_rt;
+		faceArea[i] = mesh.FaceArea(rt, nf);
+	}
+	return faceArea;
+}
+
+//-----------------------------------------------------------------------------
+double CMeasureAreaTool::getValue(FEPostModel& fem, int nstate, const std::vector<FEFace*>& selectedFaces)
+{
+	std::vector<double> buf;
+	const std::vector<double>& faceArea = faceAreas(fem, nstate, selectedFaces, buf);
+
+	FEState* state = fem.GetState(nstate);
+	double area = 0.0;
+	int N = (int)selectedFaces.size();
+	for (int i = 0; i<N; ++i)
 	{
 		FEFace& f = *selectedFaces[i];
 
 		float v = state->m_FACE[f.GetID() - 1].m_val;
 		if ((m_bfilter == false) || ((v >= m_minFilter) && (v <= m_maxFilter)))
 		{
-			rt.resize(f.Nodes());
-			for (int j = 0; j < f.Nodes(); ++j) rt[j] = state->m_NODE[f.n[j]].m_rt;
-			area += mesh.FaceArea(rt, f.Nodes());
-			++nsel;
+			area += faceArea[i];
 		}
 	}
 	return area;
@@ -152,6 +216,9 @@ double CMeasureAreaTool::getValue(FEState* state, const std::vector<FEFace*>& se
 // update
 void CMeasureAreaTool::update(bool breset)
 {
+	// the model may have changed
+	if (breset) m_faceArea.clear();
+
 	// Turned this off since otherwise it would show the graph window each time 
 	// a user changed the selection or the time step
 //	OnApply();
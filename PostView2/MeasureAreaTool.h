@@ -34,6 +34,7 @@ class FEFace;
 
 namespace Post {
 	class FEState;
+	class FEPostModel;
 }
 
 //-----------------------------------------------------------------------------
@@ -64,7 +65,9 @@ public:
 	void update(bool breset) override;
 
 private:
-	double getValue(Post::FEState* state, const std::vector<FEFace*>& selection);
+	double getValue(Post::FEPostModel& fem, int nstate, const std::vector<FEFace*>& selection);
+	const std::vector<double>& faceAreas(Post::FEPostModel& fem, int nstate, const std::vector<FEFace*>& selection, std::vector<double>& buf);
+	void validateCache(CDocument* doc, const std::vector<FEFace*>& selection);
 
 private:
 	int		m_nsel;		// selected faces
@@ -75,5 +78,14 @@ private:
 	double	m_maxFilter;
 	bool	m_allSteps;
 
+	// The face areas of the selection are cached per state, so that changing
+	// the filter only requires summing them again. The cache is cleared when
+	// the model, its data or the selection changes, and it is not used when
+	// it would hold more than MAX_CACHED_AREAS values.
+	std::vector< std::vector<double> >	m_faceArea;		// face areas per state (empty if not evaluated)
+	std::vector<int>					m_cacheFaces;	// IDs of the faces in the cache
+	unsigned int						m_cacheModel;	// model ID of the cache
+	unsigned int						m_cacheRev;		// data revision of the cache
+
 	friend class Props;
 };
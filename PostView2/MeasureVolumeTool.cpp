@@ -28,6 +28,9 @@ SOFTWARE.*/
 #include "MeasureVolumeTool.h"
 #include "Document.h"
 #include <PostLib/FEPostModel.h>
+#include "MainWindow.h"
+#include "ParallelFor.h"
+#include "SurfaceTree.h"
 using namespace Post;
 
 //-----------------------------------------------------------------------------
@@ -36,6 +39,7 @@ CMeasureVolumeTool::Props::Props(CMeasureVolumeTool* ptool) : m_ptool(ptool)
 	addProperty("selected faces", CProperty::Int)->setFlags(CProperty::Visible);
 	addProperty("volume", CProperty::Float)->setFlags(CProperty::Visible);
 	addProperty("symmetry", CProperty::Enum)->setEnumValues(QStringList() << "(None)" << "X" << "Y" << "Z");
+	addProperty("all time steps", CProperty::Bool);
 }
 
 //-----------------------------------------------------------------------------
@@ -46,6 +50,7 @@ QVariant CMeasureVolumeTool::Props::GetPropertyValue(int i)
 	case 0: return m_ptool->m_nsel; break;
 	case 1: return m_ptool->m_vol; break;
 	case 2: return m_ptool->m_nformula; break;
+	case 3: return m_ptool->m_allSteps; break;
 	}
 	return QVariant();
 }
@@ -54,6 +59,7 @@ QVariant CMeasureVolumeTool::Props::GetPropertyValue(int i)
 void CMeasureVolumeTool::Props::SetPropertyValue(int i, const QVariant& v)
 {
 	if (i == 2) m_ptool->m_nformula = v.toInt();
+	if (i == 3) m_ptool->m_allSteps = v.toBool();
 }
 
 //-----------------------------------------------------------------------------
@@ -62,6 +68,7 @@ CMeasureVolumeTool::CMeasureVolumeTool(CMainWindow* wnd) : CBasicTool("Measure V
 	m_nsel = 0;
 	m_vol = 0.0;
 	m_nformula = 0;
+	m_allSteps = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -79,30 +86,70 @@ void CMeasureVolumeTool::OnApply()
 	if (doc && doc->IsValid())
 	{
 		FEPostModel& fem = *doc->GetFEModel();
-		int ntime = fem.CurrentTime();
-		Post::FEPostMesh& mesh = *fem.GetFEMesh(0);
+		int index = doc->GetGLModel()->CurrentTimeIndex();
 		const vector<FEFace*> selectedFaces = doc->GetGLModel()->GetFaceSelection();
-		int N = (int)selectedFaces.size();
-		for (int i = 0; i<N; ++i)
+		m_nsel = (int)selectedFaces.size();
+
+		if (m_allSteps)
+		{
+			// Evaluate the volume of all states that share the current mesh. The other
+			// states are skipped, since the selection does not apply to their mesh.
+			Post::FEPostMesh* currentMesh = fem.GetState(index)->GetFEMesh();
+			int nstates = fem.GetStates();
+			std::vector<double> vol(nstates, 0.0);
+			ParallelFor(nstates, [&](int i) {
+				FEState* state = fem.GetState(i);
+				if (state->GetFEMesh() == currentMesh)
+					vol[i] = getValue(state, selectedFaces);
+				else
+					vol[i] = qQNaN();	// not plotted
+			}, 1);
+
+			m_vol = vol[index];
+			updateUi();
+
+			m_wnd->ShowData(vol, "Volume");
+			return;
+		}
+
+		m_vol = getValue(fem.GetState(index), selectedFaces);
+	}
+	updateUi();
+}
+
+//-----------------------------------------------------------------------------
+// Calculates the volume enclosed by the faces from the deformed coordinates of
+// the state. The faces are split into triangles, for which the surface integral
+// of the divergence theorem is exact. This is used for a single state as well as
+// for all time steps.
+double CMeasureVolumeTool::getValue(FEState* state, const std::vector<FEFace*>& selectedFaces)
+{
+	double vol = 0.0;
+	int N = (int)selectedFaces.size();
+	for (int i = 0; i < N; ++i)
+	{
+		FEFace& f = *selectedFaces[i];
+		int ntri;
+		const int* tri = FaceTriangulation(f.Nodes(), ntri);
+		for (int k = 0; k < ntri; ++k)
 		{
-			FEFace& f = *selectedFaces[i];
+			vec3d a = state->m_NODE[f.n[tri[3*k    ]]].m_rt;
+			vec3d b = state->m_NODE[f.n[tri[3*k + 1]]].m_rt;
+			vec3d c = state->m_NODE[f.n[tri[3*k + 2]]].m_rt;
 
-			// get the average position, area and normal
-			vec3d r = mesh.FaceCenter(f);
-			double area = mesh.FaceArea(f);
-			vec3d N = f.m_fn;
+			// area vector and center of the triangle
+			vec3d A = ((b - a) ^ (c - a))*0.5;
+			vec3d x = (a + b + c) / 3.0;
 
 			switch (m_nformula)
 			{
-			case 0: m_vol += area*(N*r) / 3.f; break;
-			case 1: m_vol += 2.f*area*(r.x*N.x); break;
-			case 2: m_vol += 2.f*area*(r.y*N.y); break;
-			case 3: m_vol += 2.f*area*(r.z*N.z); break;
+			case 0: vol += (A*x) / 3.0; break;
+			case 1: vol += 2.0*(A.x*x.x); break;
+			case 2: vol += 2.0*(A.y*x.y); break;
+			case 3: vol += 2.0*(A.z*x.z); break;
 			}
-			++m_nsel;
 		}
-
-		m_vol = fabs(m_vol);
 	}
-	updateUi();
+
+	return fabs(vol);
 }
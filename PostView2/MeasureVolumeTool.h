@@ -25,9 +25,15 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.*/
 
 #include "Tool.h"
+#include <vector>
 
 //-----------------------------------------------------------------------------
 class CDocument;
+class FEFace;
+
+namespace Post {
+	class FEState;
+}
 
 //-----------------------------------------------------------------------------
 class CMeasureVolumeTool : public CBasicTool
@@ -52,10 +58,14 @@ public:
 	// Apply button
 	void OnApply();
 
+private:
+	double getValue(Post::FEState* state, const std::vector<FEFace*>& selectedFaces);
+
 private:
 	int		m_nsel;		// selected faces
 	double	m_vol;		// volume of selection
 	int		m_nformula;	// choose formula
+	bool	m_allSteps;	// evaluate all time steps
 
 	friend class Props;
 };
@@ -0,0 +1,88 @@
+/*This file is part of the PostView source code and is licensed under the MIT license
+listed below.
+
+See Copyright-PostView.txt for details.
+
+Copyright (c) 2020 University of Utah, The Trustees of Columbia University in 
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#pragma once
+#include <thread>
+#include <atomic>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Threading rule for PostLib data: the model can be read from several threads
+// at once (e.g. FEState values, nodal positions, mesh geometry), as long as
+// nothing modifies it at the same time. Everything that modifies the model
+// (FEPostModel::Evaluate, CGLDisplacementMap::UpdateState, writing to data fields
+// or the mesh) is done on one thread. So a parallel loop can read the model
+// and write to its own buffers, which are copied into the model afterwards.
+
+//-----------------------------------------------------------------------------
+// Number of worker threads used by the parallel loops below.
+inline int ParallelThreads()
+{
+	int n = (int)std::thread::hardware_concurrency();
+	return (n < 1 ? 1 : n);
+}
+
+//-----------------------------------------------------------------------------
+// Evaluates f(i, thread) for all i in [0, n). Items are handed out in chunks
+// from a shared counter, so uneven work balances over the threads. The thread
+// index is in [0, ParallelThreads()) and can be used to address per-thread
+// accumulators, which the caller then reduces.
+template <class F> void ParallelForThread(int n, F f, int chunk = 0)
+{
+	if (n <= 0) return;
+
+	int nthreads = ParallelThreads();
+	if (chunk <= 0) chunk = n / (8 * nthreads);
+	if (chunk < 1) chunk = 1;
+
+	// don't bother spawning threads for small loops
+	if ((nthreads == 1) || (n <= chunk))
+	{
+		for (int i = 0; i < n; ++i) f(i, 0);
+		return;
+	}
+
+	std::atomic<int> next(0);
+	auto worker = [&](int thread) {
+		for (int i0 = next.fetch_add(chunk); i0 < n; i0 = next.fetch_add(chunk))
+		{
+			int i1 = (i0 + chunk < n ? i0 + chunk : n);
+			for (int i = i0; i < i1; ++i) f(i, thread);
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (int i = 1; i < nthreads; ++i) pool.push_back(std::thread(worker, i));
+	worker(0);
+	for (std::thread& t : pool) t.join();
+}
+
+//-----------------------------------------------------------------------------
+// Evaluates f(i) for all i in [0, n) on all available cores.
+template <class F> void ParallelFor(int n, F f, int chunk = 0)
+{
+	ParallelForThread(n, [&](int i, int) { f(i); }, chunk);
+}
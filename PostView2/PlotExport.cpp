@@ -0,0 +1,362 @@
+/*This file is part of the PostView source code and is licensed under the MIT license
+listed below.
+
+See Copyright-PostView.txt for details.
+
+Copyright (c) 2020 University of Utah, The Trustees of Columbia University in 
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#include "stdafx.h"
+#include "PlotExport.h"
+#include "PlotWidget.h"
+#include "BackgroundTask.h"
+#include <QLocale>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Collects the output in a large buffer, so that the file is written in a few
+// big blocks instead of one stdio call per value. The numbers are formatted
+// with the C locale, so the files don't depend on the user's decimal separator.
+class CBufferedWriter
+{
+public:
+	CBufferedWriter(FILE* fp) : m_fp(fp), m_n(0), m_ok(true), m_loc(QLocale::c()) { m_buf.resize(1 << 20); }
+	~CBufferedWriter() { flush(); }
+
+	void write(const void* pd, size_t n)
+	{
+		if (m_n + n > m_buf.size()) flush();
+		if (n > m_buf.size())
+		{
+			if (fwrite(pd, 1, n, m_fp) != n) m_ok = false;
+			return;
+		}
+		memcpy(&m_buf[m_n], pd, n);
+		m_n += n;
+	}
+
+	void put(char c)
+	{
+		if (m_n == m_buf.size()) flush();
+		m_buf[m_n++] = c;
+	}
+
+	void text(const char* sz) { write(sz, strlen(sz)); }
+
+	// write the shortest representation that reads back as the same value,
+	// right-aligned to width characters
+	void number(double v, int width = 0)
+	{
+		QByteArray s = m_loc.toString(v, 'g', QLocale::FloatingPointShortest).toLatin1();
+		for (int i = s.size(); i < width; ++i) put(' ');
+		write(s.constData(), s.size());
+	}
+
+	// write a CSV field, quoted if necessary
+	void csvField(const std::string& s)
+	{
+		if (s.find_first_of(",\"\n") == std::string::npos) { write(s.c_str(), s.size()); return; }
+		put('"');
+		for (char c : s)
+		{
+			if (c == '"') put('"');
+			put(c);
+		}
+		put('"');
+	}
+
+	bool flush()
+	{
+		if (m_n > 0)
+		{
+			if (fwrite(&m_buf[0], 1, m_n, m_fp) != m_n) m_ok = false;
+			m_n = 0;
+		}
+		return m_ok;
+	}
+
+	bool ok() const { return m_ok; }
+
+private:
+	FILE*				m_fp;
+	std::vector<char>	m_buf;
+	size_t				m_n;
+	bool				m_ok;
+	QLocale				m_loc;
+};
+
+//-----------------------------------------------------------------------------
+void GetPlotExportData(CPlotWidget& plot, PLOT_EXPORT_DATA& data)
+{
+	data.title = plot.title().toStdString();
+
+	int nplots = plot.plots();
+	data.series.resize(nplots);
+	for (int i = 0; i < nplots; ++i)
+	{
+		CPlotData& di = plot.getPlotData(i);
+		PLOT_SERIES& si = data.series[i];
+		si.label = di.label().toStdString();
+
+		int N = di.size();
+		si.x.resize(N);
+		si.y.resize(N);
+		for (int j = 0; j < N; ++j)
+		{
+			si.x[j] = di.x(j);
+			si.y[j] = di.y(j);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// see if all series have the same number of points
+static bool sameSize(const PLOT_EXPORT_DATA& data)
+{
+	for (size_t i = 1; i < data.series.size(); ++i)
+		if (data.series[i].x.size() != data.series[0].x.size()) return false;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// see if all series have the same x-values
+static bool sharedXValues(const PLOT_EXPORT_DATA& data)
+{
+	for (size_t i = 1; i < data.series.size(); ++i)
+		if (data.series[i].x != data.series[0].x) return false;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+static int maxRows(const PLOT_EXPORT_DATA& data)
+{
+	int rows = 0;
+	for (size_t i = 0; i < data.series.size(); ++i)
+		if ((int)data.series[i].x.size() > rows) rows = (int)data.series[i].x.size();
+	return rows;
+}
+
+//-----------------------------------------------------------------------------
+static bool isCancelled(CTaskProgress* progress)
+{
+	return (progress && progress->IsCancelled());
+}
+
+//-----------------------------------------------------------------------------
+// Reports progress and checks for cancellation every 4096 rows.
+static bool checkRow(int j, CBufferedWriter& out, CTaskProgress* progress)
+{
+	if ((j & 0xFFF) == 0xFFF)
+	{
+		if (isCancelled(progress) || (out.ok() == false)) return false;
+		if (progress) progress->Increment(0x1000);
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Writes the text layout. If all series have the same number of points, the
+// output is identical to what the graph window always wrote: the x-values of
+// the first series, followed by the y-values of all series, each as "%16.9g ".
+static bool exportText(const PLOT_EXPORT_DATA& data, CBufferedWriter& out, CTaskProgress* progress)
+{
+	int nplots = (int)data.series.size();
+	bool shared = sameSize(data);
+
+	int rows = maxRows(data);
+	if (progress) progress->SetTotal(rows);
+
+	out.text("#Data : "); out.text(data.title.c_str()); out.put('\n');
+	out.put('\n');
+
+	for (int j = 0; j < rows; ++j)
+	{
+		if (shared)
+		{
+			out.number(data.series[0].x[j], 16); out.put(' ');
+			for (int i = 0; i < nplots; ++i) { out.number(data.series[i].y[j], 16); out.put(' '); }
+		}
+		else
+		{
+			for (int i = 0; i < nplots; ++i)
+			{
+				const PLOT_SERIES& si = data.series[i];
+				if (j < (int)si.x.size())
+				{
+					out.number(si.x[j], 16); out.put(' ');
+					out.number(si.y[j], 16); out.put(' ');
+				}
+				else out.text("             nan              nan ");
+			}
+		}
+		out.put('\n');
+
+		if (checkRow(j, out, progress) == false) return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Writes the wide CSV layout, i.e. one or two columns per series.
+static bool exportCSVWide(const PLOT_EXPORT_DATA& data, CBufferedWriter& out, CTaskProgress* progress)
+{
+	int nplots = (int)data.series.size();
+	bool shared = sharedXValues(data);
+
+	int rows = maxRows(data);
+	if (progress) progress->SetTotal(rows);
+
+	// header
+	if (shared) out.text("x");
+	for (int i = 0; i < nplots; ++i)
+	{
+		const std::string& label = data.series[i].label;
+		if (shared == false)
+		{
+			if (i > 0) out.put(',');
+			out.csvField("x:" + label);
+		}
+		out.put(',');
+		out.csvField(label);
+	}
+	out.put('\n');
+
+	// data
+	for (int j = 0; j < rows; ++j)
+	{
+		if (shared) out.number(data.series[0].x[j]);
+		for (int i = 0; i < nplots; ++i)
+		{
+			const PLOT_SERIES& si = data.series[i];
+			bool has = (j < (int)si.x.size());
+			if (shared == false)
+			{
+				if (i > 0) out.put(',');
+				if (has) out.number(si.x[j]);
+			}
+			out.put(',');
+			if (has) out.number(si.y[j]);
+		}
+		out.put('\n');
+
+		if (checkRow(j, out, progress) == false) return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Writes the long layout, i.e. one row per point.
+static bool exportCSVLong(const PLOT_EXPORT_DATA& data, CBufferedWriter& out, CTaskProgress* progress)
+{
+	int nplots = (int)data.series.size();
+	if (progress) progress->SetTotal(nplots);
+
+	out.text("series,x,y\n");
+	for (int i = 0; i < nplots; ++i)
+	{
+		const PLOT_SERIES& si = data.series[i];
+		for (int j = 0; j < (int)si.x.size(); ++j)
+		{
+			out.csvField(si.label);
+			out.put(',');
+			out.number(si.x[j]);
+			out.put(',');
+			out.number(si.y[j]);
+			out.put('\n');
+		}
+
+		if (isCancelled(progress) || (out.ok() == false)) return false;
+		if (progress) progress->Increment();
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+static bool exportBinary(const PLOT_EXPORT_DATA& data, CBufferedWriter& out, CTaskProgress* progress)
+{
+	int nplots = (int)data.series.size();
+	if (progress) progress->SetTotal(nplots);
+
+	out.write("PVPLOT01", 8);
+	int32_t nseries = nplots;
+	out.write(&nseries, sizeof(nseries));
+
+	for (int i = 0; i < nplots; ++i)
+	{
+		const PLOT_SERIES& si = data.series[i];
+
+		int32_t nlabel = (int32_t)si.label.size();
+		out.write(&nlabel, sizeof(nlabel));
+		out.write(si.label.c_str(), nlabel);
+
+		int64_t npoints = (int64_t)si.x.size();
+		out.write(&npoints, sizeof(npoints));
+		if (npoints > 0)
+		{
+			out.write(&si.x[0], si.x.size() * sizeof(double));
+			out.write(&si.y[0], si.y.size() * sizeof(double));
+		}
+
+		if (isCancelled(progress) || (out.ok() == false)) return false;
+		if (progress) progress->Increment();
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool ExportPlotData(const PLOT_EXPORT_DATA& data, const std::string& fileName, int format, CTaskProgress* progress)
+{
+	if (data.series.empty()) return false;
+
+	FILE* fp = fopen(fileName.c_str(), (format == EXPORT_BINARY ? "wb" : "wt"));
+	if (fp == 0) return false;
+
+	bool bret = false;
+	{
+		CBufferedWriter out(fp);
+		switch (format)
+		{
+		case EXPORT_TEXT    : bret = exportText(data, out, progress); break;
+		case EXPORT_CSV_WIDE: bret = exportCSVWide(data, out, progress); break;
+		case EXPORT_CSV_LONG: bret = exportCSVLong(data, out, progress); break;
+		case EXPORT_BINARY  : bret = exportBinary(data, out, progress); break;
+		}
+		bret = out.flush() && bret;
+	}
+	fclose(fp);
+
+	// don't leave partial files behind
+	if (bret == false) remove(fileName.c_str());
+
+	return bret;
+}
+
+//-----------------------------------------------------------------------------
+bool ExportPlotData(CPlotWidget& plot, const std::string& fileName, int format, CTaskProgress* progress)
+{
+	PLOT_EXPORT_DATA data;
+	GetPlotExportData(plot, data);
+	return ExportPlotData(data, fileName, format, progress);
+}
@@ -0,0 +1,86 @@
+/*This file is part of the PostView source code and is licensed under the MIT license
+listed below.
+
+See Copyright-PostView.txt for details.
+
+Copyright (c) 2020 University of Utah, The Trustees of Columbia University in 
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#pragma once
+#include <string>
+#include <vector>
+
+class CPlotWidget;
+class CTaskProgress;
+
+//-----------------------------------------------------------------------------
+// File formats for exporting the data of a plot widget
+enum PlotExportFormat
+{
+	EXPORT_TEXT,		// space separated columns with a title line (the classic format)
+	EXPORT_CSV_WIDE,	// one column per series (x is shared if all series have the same x-values)
+	EXPORT_CSV_LONG,	// one row per point: series, x, y
+	EXPORT_BINARY		// binary columnar format (see below)
+};
+
+//-----------------------------------------------------------------------------
+// A copy of the data of a plot widget. The export works on a copy so that it
+// can run on a worker thread while the graph is updated.
+struct PLOT_SERIES
+{
+	std::string			label;
+	std::vector<double>	x;
+	std::vector<double>	y;
+};
+
+struct PLOT_EXPORT_DATA
+{
+	std::string					title;
+	std::vector<PLOT_SERIES>	series;
+};
+
+// copy the data of the plot widget
+void GetPlotExportData(CPlotWidget& plot, PLOT_EXPORT_DATA& data);
+
+//-----------------------------------------------------------------------------
+// Exports all the series. Series can have different lengths.
+//
+// The text format is the classic format of the graph window: a column of x-values,
+// followed by one column of y-values per series. If the series do not all have the
+// same number of points, each series gets its own x column instead and missing
+// values are written as nan. In the wide CSV layout, missing values are left empty.
+//
+// The binary format stores (little endian, as written by the host):
+//   char[8]  "PVPLOT01"
+//   int32    number of series
+//   for each series:
+//     int32    length of label in bytes, followed by the UTF-8 label
+//     int64    number of points n
+//     double   x[n]
+//     double   y[n]
+//
+// If progress is given, it is updated per row (or per series for the binary
+// format) and the export stops when it is cancelled. Returns false on error or
+// when cancelled, in which case the partial file is removed.
+bool ExportPlotData(const PLOT_EXPORT_DATA& data, const std::string& fileName, int format, CTaskProgress* progress = nullptr);
+
+// copies the data of the plot widget and exports it
+bool ExportPlotData(CPlotWidget& plot, const std::string& fileName, int format, CTaskProgress* progress = nullptr);
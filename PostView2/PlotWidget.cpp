@@ -26,6 +26,7 @@ SOFTWARE.*/
 
 #include "stdafx.h"
 #include "PlotWidget.h"
+#include "PlotExport.h"
 #include <QPainter>
 #include <QFontDatabase>
 #include <QMouseEvent>
@@ -36,6 +37,7 @@ SOFTWARE.*/
 #include <QClipboard>
 #include <assert.h>
 #include <math.h>
+#include <algorithm>
 #include <QFormLayout>
 #include <QDialogButtonBox>
 #include <QBoxLayout>
@@ -157,28 +159,92 @@ double findScale(double fmin, double fmax)
 }
 
 //=============================================================================
+// Builds the polyline that represents the curve on screen. When the x-values
+// are sorted, only the points inside the view are processed and, if there are
+// many more points than pixel columns, each column is reduced to its first,
+// minimum, maximum and last point. This keeps the drawing cost proportional
+// to the width of the widget, while zooming in still shows all the points.
+void CLineChartData::buildLine(CPlotWidget& plt, QPolygon& line)
+{
+	int N = size();
+	line.clear();
+
+	if (isSorted() == false)
+	{
+		line.resize(N);
+		for (int i = 0; i < N; ++i) line[i] = plt.ViewToScreen(Point(i));
+		return;
+	}
+
+	// find the visible range, including one point on either side so the line reaches the edges
+	QRectF vr = plt.m_viewRect;
+	int i0 = lowerBound(vr.left()) - 1;
+	int i1 = lowerBound(vr.right()) + 1;
+	if (i0 < 0) i0 = 0;
+	if (i1 >= N) i1 = N - 1;
+
+	// no need to decimate if there are not many more points than pixels
+	int W = plt.ScreenRect().width();
+	if (i1 - i0 + 1 <= 4 * W)
+	{
+		line.reserve(i1 - i0 + 1);
+		for (int i = i0; i <= i1; ++i) line.append(plt.ViewToScreen(Point(i)));
+		return;
+	}
+
+	// min/max decimation per pixel column
+	line.reserve(4 * W + 8);
+	QPoint p0 = plt.ViewToScreen(Point(i0));
+	QPoint first = p0, last = p0, pmin = p0, pmax = p0;
+	int imin = i0, imax = i0;
+	auto flush = [&]() {
+		line.append(first);
+		if (imin < imax) { line.append(pmin); line.append(pmax); }
+		else if (imax < imin) { line.append(pmax); line.append(pmin); }
+		line.append(last);
+	};
+
+	for (int i = i0 + 1; i <= i1; ++i)
+	{
+		QPoint pi = plt.ViewToScreen(Point(i));
+		if (pi.x() != first.x())
+		{
+			flush();
+			first = last = pmin = pmax = pi;
+			imin = imax = i;
+		}
+		else
+		{
+			last = pi;
+			// note that screen y points down
+			if (pi.y() > pmin.y()) { pmin = pi; imin = i; }
+			if (pi.y() < pmax.y()) { pmax = pi; imax = i; }
+		}
+	}
+	flush();
+}
+
+//-----------------------------------------------------------------------------
 void CLineChartData::draw(QPainter& p, CPlotWidget& plt)
 {
 	int N = size();
 	if (N == 0) return;
 
-	QPoint p0 = plt.ViewToScreen(Point(0)), p1(p0);
+	QPolygon line;
+	buildLine(plt, line);
+
 	QBrush b = p.brush();
 	p.setBrush(Qt::NoBrush);
-	for (int i = 1; i<N; ++i)
-	{
-		p1 = plt.ViewToScreen(Point(i));
-		p.drawLine(p0, p1);
-		p0 = p1;
-	}
+	if (line.size() > 1) p.drawPolyline(line);
 
-	// draw the marks
+	// draw the marks (only once per pixel)
 	if (plt.showDataMarks())
 	{
 		p.setBrush(b);
-		for (int i = 0; i<N; ++i)
+		for (int i = 0; i<line.size(); ++i)
 		{
-			p1 = plt.ViewToScreen(Point(i));
+			const QPoint& p1 = line[i];
+			if ((i > 0) && (p1 == line[i - 1])) continue;
 			QRect r(p1.x() - 2, p1.y() - 2, 5, 5);
 			p.drawRect(r);
 		}
@@ -195,7 +261,7 @@ void CBarChartData::draw(QPainter& p, CPlotWidget& plt)
 	p.setBrush(color());
 	for (int i = 0; i<N; ++i)
 	{
-		QPointF& pi = Point(i);
+		QPointF pi = Point(i);
 		QPoint p0 = plt.ViewToScreen(pi);
 		QPoint p1 = plt.ViewToScreen(QPointF(pi.x(), 0.0));
 		QRect r(p0.x() - 5, p0.y(), 10, p1.y() - p0.y());
@@ -204,9 +270,151 @@ void CBarChartData::draw(QPainter& p, CPlotWidget& plt)
 }
 
 //=============================================================================
+void CBandChartData::setBand(const vector<double>& x, const vector<double>& ylo, const vector<double>& yhi)
+{
+	int N = (int)x.size();
+	vector<double> px(2 * N), py(2 * N);
+	for (int i = 0; i < N; ++i)
+	{
+		px[i] = x[i]; py[i] = yhi[i];
+		px[2 * N - 1 - i] = x[i]; py[2 * N - 1 - i] = ylo[i];
+	}
+	setData(std::move(px), std::move(py));
+}
+
+//-----------------------------------------------------------------------------
+void CBandChartData::draw(QPainter& p, CPlotWidget& plt)
+{
+	int N = size();
+	if (N == 0) return;
+
+	QPolygon poly(N);
+	for (int i = 0; i < N; ++i) poly[i] = plt.ViewToScreen(Point(i));
+
+	p.setPen(Qt::NoPen);
+	p.setBrush(color());
+	p.drawPolygon(poly);
+}
+
+//=============================================================================
+CColorScatterData::CColorScatterData()
+{
+	m_vmin = m_vmax = 0.0;
+}
+
+//-----------------------------------------------------------------------------
+void CColorScatterData::addPoints(const float* x, const float* y, const float* v, int n)
+{
+	if (n <= 0) return;
+
+	// make sure the values line up with the points (the data may have been cleared)
+	int n0 = size();
+	m_v.resize(n0);
+
+	// points with a non-finite coordinate or value are skipped, since they can't be
+	// drawn and would make the bounds and the color range meaningless
+	for (int i = 0; i < n; ++i)
+	{
+		if ((qIsFinite(x[i]) == false) || (qIsFinite(y[i]) == false) || (qIsFinite(v[i]) == false)) continue;
+
+		if (m_v.empty()) m_vmin = m_vmax = v[i];
+		else if (v[i] < m_vmin) m_vmin = v[i];
+		else if (v[i] > m_vmax) m_vmax = v[i];
+
+		m_x.push_back(x[i]);
+		m_y.push_back(y[i]);
+		m_v.push_back(v[i]);
+	}
+
+	updateBounds(n0);
+}
+
+//-----------------------------------------------------------------------------
+// Blue-cyan-green-yellow-red color map
+QColor CColorScatterData::colorMap(double w)
+{
+	if (w < 0.0) w = 0.0;
+	if (w > 1.0) w = 1.0;
+	double r = 1.5 - fabs(4.0*w - 3.0);
+	double g = 1.5 - fabs(4.0*w - 2.0);
+	double b = 1.5 - fabs(4.0*w - 1.0);
+	if (r < 0.0) r = 0.0; else if (r > 1.0) r = 1.0;
+	if (g < 0.0) g = 0.0; else if (g > 1.0) g = 1.0;
+	if (b < 0.0) b = 0.0; else if (b > 1.0) b = 1.0;
+	return QColor((int)(255 * r), (int)(255 * g), (int)(255 * b));
+}
+
+//-----------------------------------------------------------------------------
+void CColorScatterData::draw(QPainter& p, CPlotWidget& plt)
+{
+	int N = size();
+	if (N == 0) return;
+
+	QRect sr = plt.ScreenRect();
+	qreal dpr = p.device()->devicePixelRatioF();
+	QImage img(sr.size()*dpr, QImage::Format_ARGB32_Premultiplied);
+	img.fill(Qt::transparent);
+	int W = img.width();
+	int H = img.height();
+	if ((W == 0) || (H == 0)) return;
+
+	// color lookup table
+	const int NCOL = 256;
+	QRgb col[NCOL];
+	for (int i = 0; i < NCOL; ++i) col[i] = colorMap((double)i / (NCOL - 1)).rgba();
+	double dv = (m_vmax > m_vmin ? (NCOL - 1) / (m_vmax - m_vmin) : 0.0);
+
+	// map view to image coordinates
+	QRectF vr = plt.m_viewRect;
+	double sx = W / vr.width();
+	double sy = H / vr.height();
+
+	// size of the point marks
+	int r = (int)(2 * dpr + 0.5);
+
+	for (int i = 0; i < N; ++i)
+	{
+		double fx = (m_x[i] - vr.left())*sx;
+		double fy = (vr.bottom() - m_y[i])*sy;
+		if ((fx < -r) || (fx >= W + r) || (fy < -r) || (fy >= H + r)) continue;
+
+		int X = (int)fx, Y = (int)fy;
+		int x0 = (X - r < 0 ? 0 : X - r), x1 = (X + r >= W ? W - 1 : X + r);
+		int y0 = (Y - r < 0 ? 0 : Y - r), y1 = (Y + r >= H ? H - 1 : Y + r);
+
+		int n = (i < (int)m_v.size() ? (int)((m_v[i] - m_vmin)*dv) : 0);
+		if (n < 0) n = 0; else if (n > NCOL - 1) n = NCOL - 1;
+		QRgb c = col[n];
+		for (int y = y0; y <= y1; ++y)
+		{
+			QRgb* line = (QRgb*)img.scanLine(y);
+			for (int x = x0; x <= x1; ++x) line[x] = c;
+		}
+	}
+
+	img.setDevicePixelRatio(dpr);
+	p.drawImage(sr.topLeft(), img);
+}
+
+//-----------------------------------------------------------------------------
+void CColorScatterData::drawLegendMark(QPainter& p, int x0, int x1, int y)
+{
+	QLinearGradient grad(x0, y, x1, y);
+	for (int i = 0; i <= 4; ++i) grad.setColorAt(i / 4.0, colorMap(i / 4.0));
+	p.fillRect(x0, y - 3, x1 - x0, 7, grad);
+}
+
+//=============================================================================
+
+// Global revision counter, so that revision numbers are unique across all plot data.
+static unsigned int plotDataRevision = 0;
 
 CPlotData::CPlotData()
 {
+	m_bsorted = true;
+	m_xmin = m_xmax = 0.0;
+	m_ymin = m_ymax = 0.0;
+	m_revision = ++plotDataRevision;
 }
 
 //-----------------------------------------------------------------------------
@@ -217,65 +425,160 @@ CPlotData::~CPlotData()
 //-----------------------------------------------------------------------------
 CPlotData::CPlotData(const CPlotData& d)
 {
-	m_data = d.m_data;
+	m_x = d.m_x;
+	m_y = d.m_y;
 	m_label = d.m_label;
 	m_col = d.m_col;
+	m_bsorted = d.m_bsorted;
+	m_xmin = d.m_xmin; m_xmax = d.m_xmax;
+	m_ymin = d.m_ymin; m_ymax = d.m_ymax;
+	m_revision = ++plotDataRevision;
 }
 
 //-----------------------------------------------------------------------------
 CPlotData& CPlotData::operator = (const CPlotData& d)
 {
-	m_data = d.m_data;
+	m_x = d.m_x;
+	m_y = d.m_y;
 	m_label = d.m_label;
 	m_col = d.m_col;
+	m_bsorted = d.m_bsorted;
+	m_xmin = d.m_xmin; m_xmax = d.m_xmax;
+	m_ymin = d.m_ymin; m_ymax = d.m_ymax;
+	changed();
 	return *this;
 }
 
+//-----------------------------------------------------------------------------
+void CPlotData::drawLegendMark(QPainter& p, int x0, int x1, int y)
+{
+	p.setPen(QPen(color(), 2));
+	p.drawLine(x0, y, x1, y);
+}
+
+//-----------------------------------------------------------------------------
+void CPlotData::changed()
+{
+	m_revision = ++plotDataRevision;
+}
+
 //-----------------------------------------------------------------------------
 void CPlotData::clear()
 { 
-	m_data.clear(); 
+	m_x.clear(); 
+	m_y.clear();
+	m_bsorted = true;
+	m_xmin = m_xmax = 0.0;
+	m_ymin = m_ymax = 0.0;
+	changed();
 }
 
 //-----------------------------------------------------------------------------
-QRectF CPlotData::boundRect() const
+void CPlotData::reserve(int n)
 {
-	if (m_data.empty()) return QRectF(0., 0., 0., 0.);
+	m_x.reserve(n);
+	m_y.reserve(n);
+}
 
-	QRectF r(m_data[0].x(), m_data[0].y(), 0.0, 0.0);
-	for (int i=1; i<(int)m_data.size(); ++i)
+//-----------------------------------------------------------------------------
+// Includes the points n0 and up in the bounds and the sorted flag.
+void CPlotData::updateBounds(int n0)
+{
+	int N = size();
+	if (n0 >= N) return;
+	if (n0 == 0)
 	{
-		const QPointF& p = m_data[i];
-		if (p.x() < r.left  ()) r.setLeft  (p.x());
-		if (p.x() > r.right ()) r.setRight (p.x());
-		if (p.y() > r.bottom()) r.setBottom(p.y());
-		if (p.y() < r.top   ()) r.setTop   (p.y());
+		m_xmin = m_xmax = m_x[0];
+		m_ymin = m_ymax = m_y[0];
+		m_bsorted = true;
 	}
-	return r;
+	else if (m_bsorted && (m_x[n0] < m_x[n0 - 1])) m_bsorted = false;
+
+	for (int i = n0; i < N; ++i)
+	{
+		double x = m_x[i], y = m_y[i];
+		if (x < m_xmin) m_xmin = x;
+		if (x > m_xmax) m_xmax = x;
+		if (y < m_ymin) m_ymin = y;
+		if (y > m_ymax) m_ymax = y;
+		if (m_bsorted && (i > 0) && (x < m_x[i - 1])) m_bsorted = false;
+	}
+	changed();
+}
+
+//-----------------------------------------------------------------------------
+QRectF CPlotData::boundRect() const
+{
+	if (m_x.empty()) return QRectF(0., 0., 0., 0.);
+	return QRectF(m_xmin, m_ymin, m_xmax - m_xmin, m_ymax - m_ymin);
 }
 
 //-----------------------------------------------------------------------------
 void CPlotData::addPoint(double x, double y)
 {
-	QPointF p(x, y);
-	m_data.push_back(p);
+	int n0 = size();
+	m_x.push_back(x);
+	m_y.push_back(y);
+	updateBounds(n0);
+}
+
+//-----------------------------------------------------------------------------
+void CPlotData::addPoints(const double* x, const double* y, int n)
+{
+	int n0 = size();
+	m_x.insert(m_x.end(), x, x + n);
+	m_y.insert(m_y.end(), y, y + n);
+	updateBounds(n0);
+}
+
+//-----------------------------------------------------------------------------
+void CPlotData::addPoints(const float* x, const float* y, int n)
+{
+	int n0 = size();
+	m_x.insert(m_x.end(), x, x + n);
+	m_y.insert(m_y.end(), y, y + n);
+	updateBounds(n0);
 }
 
 //-----------------------------------------------------------------------------
-int compare(const void* p1, const void* p2)
+void CPlotData::setData(vector<double>&& x, vector<double>&& y)
 {
-	const QPointF& r1 = *((const QPointF*)(p1));
-	const QPointF& r2 = *((const QPointF*)(p2));
+	assert(x.size() == y.size());
+	m_x = std::move(x);
+	m_y = std::move(y);
+	if (m_x.empty()) clear();
+	else updateBounds(0);
+}
 
-	if (r1.x() < r2.x()) return -1;
-	else if (r1.x() > r2.x()) return 1;
-	else return 0;
+//-----------------------------------------------------------------------------
+int CPlotData::lowerBound(double x) const
+{
+	assert(m_bsorted);
+	return (int)(std::lower_bound(m_x.begin(), m_x.end(), x) - m_x.begin());
 }
 
+//-----------------------------------------------------------------------------
+// Sorts the points by their x-value. Nothing is done if the data is already sorted.
 void CPlotData::sort()
 {
-	if (m_data.size() > 0)
-		qsort(&m_data[0], m_data.size(), sizeof(QPointF), compare);
+	if (m_bsorted) return;
+
+	int N = size();
+	vector<int> index(N);
+	for (int i = 0; i < N; ++i) index[i] = i;
+	std::stable_sort(index.begin(), index.end(), [this](int a, int b) { return m_x[a] < m_x[b]; });
+
+	vector<double> x(N), y(N);
+	for (int i = 0; i < N; ++i)
+	{
+		x[i] = m_x[index[i]];
+		y[i] = m_y[index[i]];
+	}
+	m_x.swap(x);
+	m_y.swap(y);
+
+	m_bsorted = true;
+	changed();
 }
 
 //-----------------------------------------------------------------------------
@@ -305,6 +608,9 @@ CPlotWidget::CPlotWidget(QWidget* parent, int w, int h) : QWidget(parent)
 
 	m_bautoRngUpdate = true;
 
+	m_blayersValid = false;
+	m_layerData = 0;
+
 	// set default colors
 	m_bgCol = QColor(255, 255, 255);
 	m_gridCol = QColor(192, 192, 192);
@@ -344,6 +650,7 @@ CPlotWidget::CPlotWidget(QWidget* parent, int w, int h) : QWidget(parent)
 void CPlotWidget::setChartStyle(int chartStyle)
 {
 	m_chartStyle = chartStyle;
+	invalidate();
 }
 
 //-----------------------------------------------------------------------------
@@ -431,7 +738,7 @@ void CPlotWidget::OnCopyToClipboard()
 			// see if x-coordinates match
 			for (int j=0; j<max_size; ++j)
 			{
-				if (d.Point(j).x() != di.Point(j).x())
+				if (d.x(j) != di.x(j))
 				{
 					equalSize = false;
 					break;
@@ -450,13 +757,11 @@ void CPlotWidget::OnCopyToClipboard()
 		s += '\n';
 		for (int i = 0; i<d.size(); ++i)
 		{
-			QPointF& pi = d.Point(i);
-			s.append(QString::asprintf("%lg", pi.x()));
+			s.append(QString::asprintf("%lg", d.x(i)));
 
 			for (int j = 0; j<plots(); ++j)
 			{
-				QPointF& pi = m_data[j]->Point(i);
-				s.append(QString::asprintf("\t%lg", pi.y()));
+				s.append(QString::asprintf("\t%lg", m_data[j]->y(i)));
 			}
 
 			s += '\n';
@@ -478,8 +783,8 @@ void CPlotWidget::OnCopyToClipboard()
 			{
 				if (i < m_data[j]->size())
 				{
-					QPointF& pi = m_data[j]->Point(i);
-					s.append(QString::asprintf("%lg\t%lg\t", pi.x(), pi.y()));
+					CPlotData& dj = *m_data[j];
+					s.append(QString::asprintf("%lg\t%lg\t", dj.x(i), dj.y(i)));
 				}
 				else s.append("\t\t");
 			}
@@ -494,6 +799,7 @@ void CPlotWidget::OnCopyToClipboard()
 void CPlotWidget::setTitle(const QString& t)
 {
 	m_title = t;
+	invalidate();
 }
 
 //-----------------------------------------------------------------------------
@@ -664,14 +970,24 @@ void CPlotWidget::mousePressEvent(QMouseEvent* ev)
 		QPoint pt = ev->pos();
 		const int eps = 3;
 
+		// x-range of the points that can be hit
+		double x0 = ScreenToView(QPoint(pt.x() - eps - 1, pt.y())).x();
+		double x1 = ScreenToView(QPoint(pt.x() + eps + 1, pt.y())).x();
+
 		m_newSelect = false;
 		for (int i = 0; i<(int)m_data.size(); ++i)
 		{
 			CPlotData& plot = *m_data[i];
-			for (int j = 0; j<plot.size(); ++j)
+
+			// for sorted data, we only need to check the points near the cursor
+			int j0 = (plot.isSorted() ? plot.lowerBound(x0) : 0);
+			int j1 = plot.size();
+
+			for (int j = j0; j<j1; ++j)
 			{
-				QPointF& rj = plot.Point(j);
-				QPoint p = ViewToScreen(rj);
+				if (plot.isSorted() && (plot.x(j) > x1)) break;
+
+				QPoint p = ViewToScreen(plot.Point(j));
 				if ((abs(p.x() - pt.x()) <= eps) && (abs(p.y() - pt.y()) <= eps))
 				{
 					m_newSelect = true;
@@ -812,80 +1128,120 @@ void CPlotWidget::paintEvent(QPaintEvent* pe)
 	// Process base event first
 	QWidget::paintEvent(pe);
 
-	// store the current rectangle
-	m_screenRect = rect();
-	if ((m_screenRect.width()==0)||
-		(m_screenRect.height()==0)) return;
+	if ((width() == 0) || (height() == 0)) return;
+
+	// make sure the cached layers are up to date
+	updateLayers();
 
 	// Create the painter class
 	QPainter p(this);
 	p.setRenderHint(QPainter::Antialiasing, true);
 
-	// clear the background
-	p.fillRect(m_screenRect, m_bgCol);
+	// draw the cached layers
+	p.drawImage(0, 0, m_backLayer);
+	p.drawImage(0, 0, m_dataLayer);
 
-/*	int W = rect().width();
-	int H = rect().height();
-	int NX = 10;
-	QStringList colorNames = QColor::colorNames();
-	int colors = colorNames.size();
-	for (int i=0; i<colors; ++i)
+	// render the overlays
+	p.setFont(QFont("Arial", 10));
+	p.setClipRect(m_screenRect);
+	if (m_bzoomRect && m_bvalidRect)
 	{
-		int X = rect().x() + ((i%10)*(rect().width()))/NX;
-		int Y = rect().y() + ((i/10)*(rect().width()))/NX;
-		int w = rect().width()/NX, h = w;
-		QColor col(colorNames[i]);
-		p.fillRect(X, Y, w, h, col);
-		QString s = QString("%1").arg(i);
-		p.drawText(X, Y, w, h, Qt::AlignCenter, s);
+		QRect rt(m_mouseInitPos, m_mousePos);
+		p.setBrush(Qt::NoBrush);
+		p.setPen(QPen(Qt::black, 1, Qt::DashLine));
+		p.drawRect(rt);
 	}
-	return;
-*/
 
-	// render the title
-	drawTitle(p);
+	// render the selection
+	if (m_select) drawSelection(p);
+}
 
-	// figure out some metrics
-	QFontMetrics fm = p.fontMetrics();
-	int fontHeight = fm.height(); // height in pixels
+//-----------------------------------------------------------------------------
+// Redraws the cached layers that are out of date. The background layer only
+// depends on the widget size, the view and the plot style. The data layer
+// also needs to be redrawn when any of the plot data changes.
+void CPlotWidget::updateLayers()
+{
+	qreal dpr = devicePixelRatioF();
+	QSize imgSize = size()*dpr;
+
+	// get the combined data revision
+	unsigned int dataKey = (unsigned int)m_data.size();
+	for (CPlotData* data : m_data) dataKey = 31*dataKey + data->revision();
 
-	// adjust the screen rectangle where the data will be drawn
-	if (m_bfullScreenMode == false)
+	bool bresize = (m_backLayer.size() != imgSize);
+	bool bback = (m_blayersValid == false) || bresize || (m_layerView != m_viewRect);
+	bool bdata = bback || (m_layerData != dataKey);
+
+	if (bback)
 	{
-		m_screenRect.setTop(m_titleRect.bottom());
-		m_screenRect.adjust(50, 0, -90, -fontHeight - 2);
-		p.setBrush(Qt::NoBrush);
-		p.drawRect(m_screenRect);
-	}
+		if (bresize)
+		{
+			m_backLayer = QImage(imgSize, QImage::Format_ARGB32_Premultiplied);
+			m_backLayer.setDevicePixelRatio(dpr);
+			m_dataLayer = QImage(imgSize, QImage::Format_ARGB32_Premultiplied);
+			m_dataLayer.setDevicePixelRatio(dpr);
+		}
 
-	// draw the grid
-	drawGrid(p);
+		// store the current rectangle
+		m_screenRect = rect();
 
-	// draw the grid axes
-	drawAxes(p);
+		QPainter p(&m_backLayer);
+		p.setRenderHint(QPainter::Antialiasing, true);
 
-	// draw the axes labels
-	drawAxesLabels(p);
+		// clear the background
+		p.fillRect(m_screenRect, m_bgCol);
 
-	// draw the legend
-	if (m_bshowLegend) drawLegend(p);
+		// render the title
+		drawTitle(p);
 
-	// render the data
-	p.setClipRect(m_screenRect);
-	drawAllData(p);
+		// figure out some metrics
+		QFontMetrics fm = p.fontMetrics();
+		int fontHeight = fm.height(); // height in pixels
 
-	if (m_bzoomRect && m_bvalidRect)
+		// adjust the screen rectangle where the data will be drawn
+		if (m_bfullScreenMode == false)
+		{
+			m_screenRect.setTop(m_titleRect.bottom());
+			m_screenRect.adjust(50, 0, -90, -fontHeight - 2);
+			p.setBrush(Qt::NoBrush);
+			p.drawRect(m_screenRect);
+		}
+
+		// draw the grid
+		drawGrid(p);
+
+		// draw the grid axes
+		drawAxes(p);
+
+		// draw the axes labels
+		drawAxesLabels(p);
+
+		m_layerView = m_viewRect;
+	}
+
+	if (bdata)
 	{
-		QRect rt(m_mouseInitPos, m_mousePos);
-		p.setBrush(Qt::NoBrush);
-		p.setPen(QPen(Qt::black, 1, Qt::DashLine));
-		p.drawRect(rt);
+		m_dataLayer.fill(Qt::transparent);
+
+		QPainter p(&m_dataLayer);
+		p.setRenderHint(QPainter::Antialiasing, true);
+		p.setFont(QFont("Arial", 10));
+
+		// draw the legend
+		if (m_bshowLegend) drawLegend(p);
+
+		// render the data
+		p.setClipRect(m_screenRect);
+		drawAllData(p);
+
+		m_layerData = dataKey;
 	}
 
-	// render the selection
-	if (m_select) drawSelection(p);
+	m_blayersValid = true;
 }
 
+//-----------------------------------------------------------------------------
 void CPlotWidget::drawLegend(QPainter& p)
 {
 	int N = (int)m_data.size();
@@ -911,9 +1267,8 @@ void CPlotWidget::drawLegend(QPainter& p)
 	for (int i=0; i<N; ++i)
 	{
 		CPlotData& plot = *m_data[i];
-		p.setPen(QPen(plot.color(), 2));
 		int Y = Y0 + i*(Y1 - Y0)/N;
-		p.drawLine(X0, Y, X0 + LW, Y);
+		plot.drawLegendMark(p, X0, X0 + LW, Y);
 	}
 
 	// draw the text
@@ -1217,27 +1572,7 @@ void CPlotWidget::drawAllData(QPainter& p)
 bool CPlotWidget::Save(const QString& fileName)
 {
 	// dump the data to a text file
-	std::string sfile = fileName.toStdString();
-	FILE* fp = fopen(sfile.c_str(), "wt");
-	if (fp == 0) return false;
-
-	std::string title = m_title.toStdString();
-	fprintf(fp, "#Data : %s\n", title.c_str());
-	fprintf(fp,"\n");
-
-	CPlotData& plot = getPlotData(0);
-	for (int i=0; i<plot.size(); i++)
-	{
-		fprintf(fp, "%16.9g ", plot.Point(i).x());
-		for (int j=0; j<plots(); j++)
-		{
-			CPlotData& plotj = getPlotData(j);
-			fprintf(fp,"%16.9g ", plotj.Point(i).y());
-		}
-		fprintf(fp,"\n");
-	}
-	fclose(fp);
-	return true;
+	return ExportPlotData(*this, fileName.toStdString(), EXPORT_TEXT);
 }
 
 //-----------------------------------------------------------------------------
@@ -1259,12 +1594,14 @@ QPointF CPlotWidget::SnapToGrid(const QPointF& p)
 void CPlotWidget::setXAxisLabelAlignment(AxisLabelAlignment a)
 {
 	m_xAxis.labelAlignment = a;
+	invalidate();
 }
 
 //-----------------------------------------------------------------------------
 void CPlotWidget::setYAxisLabelAlignment(AxisLabelAlignment a)
 {
 	m_yAxis.labelAlignment = a;
+	invalidate();
 }
 
 //-----------------------------------------------------------------------------
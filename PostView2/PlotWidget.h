@@ -28,16 +28,21 @@ SOFTWARE.*/
 #include <QWidget>
 #include <vector>
 #include <QDialog>
+#include <QImage>
 using namespace std;
 
 //-----------------------------------------------------------------------------
 class QPainter;
 class QAction;
+class QPolygon;
 class CPlotWidget;
 
 //-----------------------------------------------------------------------------
 // Manages a set of (x,y) value pairs
 // Derived classes must implement drawing function.
+// The x- and y-values are stored in separate arrays. The bounding rectangle
+// and whether the x-values are sorted are updated as points are added, so
+// neither requires a pass over the data.
 class CPlotData
 {
 public:
@@ -50,36 +55,75 @@ public:
 	//! clear data
 	void clear();
 
+	// reserve memory for n points
+	void reserve(int n);
+
 	// add a point to the data
 	void addPoint(double x, double y);
 
+	// add n points to the data
+	void addPoints(const double* x, const double* y, int n);
+	void addPoints(const float* x, const float* y, int n);
+
+	// replace the data by the x and y arrays, which are moved in
+	void setData(vector<double>&& x, vector<double>&& y);
+
 	// number of points
-	int size() const { return (int) m_data.size(); }
+	int size() const { return (int) m_x.size(); }
 
 	// get a data point
-	QPointF& Point(int i) { return m_data[i]; }
+	QPointF Point(int i) const { return QPointF(m_x[i], m_y[i]); }
+
+	// get the x or y value of a data point
+	double x(int i) const { return m_x[i]; }
+	double y(int i) const { return m_y[i]; }
 
 	// get the bounding rectangle
 	QRectF boundRect() const;
 
 	// set/get the label
 	const QString& label() const { return m_label; }
-	void setLabel(const QString& label) { m_label = label; }
+	void setLabel(const QString& label) { m_label = label; changed(); }
 
 	// set/get color
 	QColor color() const { return m_col; }
-	void setColor(const QColor& col) { m_col = col; }
+	void setColor(const QColor& col) { m_col = col; changed(); }
 
 	// sort the data
 	void sort();
 
+	// are the x-values in ascending order?
+	bool isSorted() const { return m_bsorted; }
+
+	// index of the first point whose x-value is not less than x (data must be sorted)
+	int lowerBound(double x) const;
+
+	// revision number, which changes whenever the data is modified
+	unsigned int revision() const { return m_revision; }
+
 public:
 	virtual	void draw(QPainter& painter, CPlotWidget& plt) = 0;
 
+	// draw the mark that represents this data in the legend
+	virtual void drawLegendMark(QPainter& painter, int x0, int x1, int y);
+
+protected:
+	// call when the data was modified
+	void changed();
+
+	// update the bounds and sorted flag for the points starting at n0
+	void updateBounds(int n0);
+
 protected:
-	vector<QPointF>	m_data;
+	vector<double>	m_x;
+	vector<double>	m_y;
 	QString			m_label;
 	QColor			m_col;
+	unsigned int	m_revision;
+
+	bool	m_bsorted;			// x-values are in ascending order
+	double	m_xmin, m_xmax;		// bounds of the data
+	double	m_ymin, m_ymax;
 };
 
 //-----------------------------------------------------------------------------
@@ -87,6 +131,10 @@ class CLineChartData : public CPlotData
 {
 public:
 	void draw(QPainter& painter, CPlotWidget& plt);
+
+private:
+	// build the screen polyline of the visible part of the curve
+	void buildLine(CPlotWidget& plt, QPolygon& line);
 };
 
 //-----------------------------------------------------------------------------
@@ -96,6 +144,49 @@ public:
 	void draw(QPainter& painter, CPlotWidget& plt);
 };
 
+//-----------------------------------------------------------------------------
+// Draws a filled band between a lower and an upper curve. The points are
+// stored as a closed outline: the upper curve from left to right, followed
+// by the lower curve from right to left.
+class CBandChartData : public CPlotData
+{
+public:
+	// set the band from its x-values and its lower and upper y-values
+	void setBand(const vector<double>& x, const vector<double>& ylo, const vector<double>& yhi);
+
+	void draw(QPainter& painter, CPlotWidget& plt);
+};
+
+//-----------------------------------------------------------------------------
+// Draws the points as a point cloud, where the color of each point is set
+// by a value (e.g. time) through a color map. The points are rasterized into
+// one image, so large clouds only require a single draw call.
+class CColorScatterData : public CPlotData
+{
+public:
+	CColorScatterData();
+
+	using CPlotData::addPoints;
+
+	// add n points with their color values
+	void addPoints(const float* x, const float* y, const float* v, int n);
+
+	// range of the color values
+	double minValue() const { return m_vmin; }
+	double maxValue() const { return m_vmax; }
+
+	void draw(QPainter& painter, CPlotWidget& plt);
+
+	void drawLegendMark(QPainter& painter, int x0, int x1, int y);
+
+	// evaluate the color map for w in [0,1]
+	static QColor colorMap(double w);
+
+private:
+	vector<float>	m_v;
+	double			m_vmin, m_vmax;
+};
+
 //-----------------------------------------------------------------------------
 struct CAxisFormat
 {
@@ -156,7 +247,7 @@ public:
 
 	// get/set show legend
 	bool showLegend() const { return m_bshowLegend; }
-	void showLegend(bool b) { m_bshowLegend = b; }
+	void showLegend(bool b) { m_bshowLegend = b; invalidate(); }
 
 	// change the view so that it fits the data
 	void fitWidthToData();
@@ -192,19 +283,19 @@ public:
 	// set the chart style
 	void setChartStyle(int chartStyle);
 
-	void showHorizontalGridLines(bool b) { m_bdrawYLines = b; }
-	void showVerticalGridLines(bool b) { m_bdrawXLines = b; }
+	void showHorizontalGridLines(bool b) { m_bdrawYLines = b; invalidate(); }
+	void showVerticalGridLines(bool b) { m_bdrawXLines = b; invalidate(); }
 
-	void showXAxis(bool b) { m_xAxis.visible = b; }
-	void ShowYAxis(bool b) { m_yAxis.visible = b; }
+	void showXAxis(bool b) { m_xAxis.visible = b; invalidate(); }
+	void ShowYAxis(bool b) { m_yAxis.visible = b; invalidate(); }
 
 	bool lineSmoothing() const { return m_bsmoothLines; }
-	void setLineSmoothing(bool b) { m_bsmoothLines = b; }
+	void setLineSmoothing(bool b) { m_bsmoothLines = b; invalidate(); }
 
 	bool showDataMarks() const { return m_bshowDataMarks; }
-	void showDataMarks(bool b) { m_bshowDataMarks = b; }
+	void showDataMarks(bool b) { m_bshowDataMarks = b; invalidate(); }
 
-	void scaleAxisLabels(bool b) { m_bscaleAxisLabels = b; }
+	void scaleAxisLabels(bool b) { m_bscaleAxisLabels = b; invalidate(); }
 
 	bool autoRangeUpdate() const { return m_bautoRngUpdate; }
 	void setAutoRangeUpdate(bool b) { m_bautoRngUpdate = b; }
@@ -213,21 +304,25 @@ public:
 
 	QPointF dataPoint(int ndata, int npoint);
 
-	void setFullScreenMode(bool b) { m_bfullScreenMode = b; }
+	void setFullScreenMode(bool b) { m_bfullScreenMode = b; invalidate(); }
 
 	void setXAxisLabelAlignment(AxisLabelAlignment a);
 	void setYAxisLabelAlignment(AxisLabelAlignment a);
 
-	void setBackgroundColor(const QColor& c) { m_bgCol = c; }
-	void setGridColor(const QColor& c) { m_gridCol = c; }
-	void setXAxisColor(const QColor& c) { m_xCol = c; }
-	void setYAxisColor(const QColor& c) { m_yCol = c; }
+	void setBackgroundColor(const QColor& c) { m_bgCol = c; invalidate(); }
+	void setGridColor(const QColor& c) { m_gridCol = c; invalidate(); }
+	void setXAxisColor(const QColor& c) { m_xCol = c; invalidate(); }
+	void setYAxisColor(const QColor& c) { m_yCol = c; invalidate(); }
 	void setSelectionColor(const QColor& c) { m_selCol = c; }
 
 	void selectPoint(int ndata, int npoint);
 
 	QRect ScreenRect() const { return m_screenRect; }
 
+	// mark the cached plot layers as out of date.
+	// Changes to the data and the view are detected automatically.
+	void invalidate() { m_blayersValid = false; }
+
 signals:
 	void doneZoomToRect();
 	void pointClicked(QPointF p, bool bshift);
@@ -279,6 +374,7 @@ public slots:
 	void OnCopyToClipboard();
 
 private: // drawing helper functions
+	void updateLayers();
 	void drawAxes(QPainter& p);
 	void drawAllData(QPainter& p);
 	void drawData(QPainter& p, CPlotData& data);
@@ -304,6 +400,15 @@ private:
 	CAxisFormat		m_xAxis;
 	CAxisFormat		m_yAxis;
 
+private:
+	// The static parts of the plot are cached in offscreen images, so that
+	// repaints for the zoom rectangle and selection only draw the overlays.
+	QImage			m_backLayer;	// title, frame, grid, axes and labels
+	QImage			m_dataLayer;	// data and legend
+	bool			m_blayersValid;	// false if all layers need to be redrawn
+	QRectF			m_layerView;	// view rectangle of the cached layers
+	unsigned int	m_layerData;	// data revision of the cached data layer
+
 private:
 	QAction*	m_pZoomToFit;
 	QAction*	m_pShowProps;
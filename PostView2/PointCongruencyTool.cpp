@@ -32,11 +32,17 @@ SOFTWARE.*/
 #include <QPushButton>
 #include <QFormLayout>
 #include <QLineEdit>
+#include <QMessageBox>
+#include <QApplication>
 #include "Document.h"
 #include <PostLib/FEPostModel.h>
 #include <MeshTools/SphereFit.h>
 #include "PropertyListView.h"
 #include <PostLib/FEPointCongruency.h>
+#include <PostLib/FEMeshData_T.h>
+#include <PostLib/constants.h>
+#include "BackgroundTask.h"
+#include "MainWindow.h"
 using namespace Post;
 
 class CPointCongruencyToolUI : public QWidget
@@ -59,6 +65,7 @@ public:
 	CPointCongruencyToolUI(CPointCongruencyTool* ptool)
 	{
 		QPushButton* pb;
+		QPushButton* pbsel;
 		QVBoxLayout* pv = new QVBoxLayout;
 		{
 			QFormLayout* pfi = new QFormLayout;
@@ -82,9 +89,13 @@ public:
 			pv->addLayout(pfi);
 			pv->addWidget(pb);
 			pv->addLayout(pfo);
+
+			pbsel = new QPushButton("Apply to selected nodes (all states)");
+			pv->addWidget(pbsel);
 		}
 		setLayout(pv);
 		QObject::connect(pb, SIGNAL(clicked(bool)), ptool, SLOT(OnApply()));
+		QObject::connect(pbsel, SIGNAL(clicked(bool)), ptool, SLOT(OnApplySelection()));
 	}
 };
 
@@ -128,3 +139,99 @@ void CPointCongruencyTool::OnApply()
 		}
 	}
 }
+
+// Calculates the congruency of all selected nodes for all states and stores it in a new nodal data field.
+// The mesh is moved to the configuration of each state in turn, so the states are evaluated one after
+// the other. The same congruency tool is used for all nodes.
+void CPointCongruencyTool::OnApplySelection()
+{
+	CDocument* doc = GetActiveDocument();
+	if ((doc == nullptr) || (doc->IsValid() == false)) return;
+
+	FEPostModel& fem = *doc->GetFEModel();
+	Post::FEPostMesh& mesh = *fem.GetFEMesh(0);
+
+	vector<int> sel;
+	for (int i = 0; i < mesh.Nodes(); ++i)
+	{
+		if (mesh.Node(i).IsSelected()) sel.push_back(i);
+	}
+	if (sel.empty())
+	{
+		QMessageBox::information(m_wnd, "Pt. Congruency", "Please select the nodes first.");
+		return;
+	}
+
+	FEDataField* pdf = new FEDataField_T<FENodeData<float> >("congruency", EXPORT_DATA);
+	fem.AddDataField(pdf);
+	int ndata = FIELD_CODE(pdf->GetFieldID());
+
+	// store the current nodal positions
+	int NN = mesh.Nodes();
+	vector<vec3d> r0(NN);
+	for (int i = 0; i < NN; ++i) r0[i] = mesh.Node(i).r;
+
+	int nstates = fem.GetStates();
+	int nsel = (int)sel.size();
+	vector<float> ke(nsel, 0.f);
+
+	// Stores the congruency of state n (if n >= 0) and moves the mesh to the configuration
+	// of state m (if m >= 0). The positions are evaluated with the original mesh in place.
+	vector<vec3f> rt(NN);
+	auto updateModel = [&](int n, int m) {
+		if (n >= 0)
+		{
+			// the nodes that are not selected get a zero value
+			FEState* ps = fem.GetState(n);
+			FENodeData<float>& df = dynamic_cast<FENodeData<float>&>(ps->m_Data[ndata]);
+			for (int i = 0; i < NN; ++i) df[i] = 0.f;
+			for (int i = 0; i < nsel; ++i) df[sel[i]] = ke[i];
+		}
+		if (m >= 0)
+		{
+			for (int i = 0; i < NN; ++i) mesh.Node(i).r = r0[i];
+			for (int i = 0; i < NN; ++i) rt[i] = fem.NodePosition(i, m);
+			for (int i = 0; i < NN; ++i) mesh.Node(i).r = vec3d(rt[i].x, rt[i].y, rt[i].z);
+		}
+	};
+
+	// FEPointCongruency only works on the mesh itself, and PostView has no way to make a
+	// private copy of an FEPostMesh. So the shared mesh is moved from state to state. The
+	// worker thread only reads the model. All changes to the model are made by the UI thread,
+	// while the worker waits (see ParallelFor.h). The UI thread does not render or update the
+	// model while the task runs (see BackgroundTask.h), so only the worker reads the moved mesh.
+	CTaskProgress progress(nstates*nsel);
+	bool bdone = RunBackgroundTask(m_wnd, "Calculating congruency ...", progress, [&]() {
+		FEPointCongruency tool;
+		tool.SetLevels(1);
+		for (int n = 0; n < nstates; ++n)
+		{
+			QMetaObject::invokeMethod(qApp, [&]() { updateModel(n - 1, n); }, Qt::BlockingQueuedConnection);
+
+			for (int i = 0; i < nsel; ++i)
+			{
+				if (progress.IsCancelled()) return;
+
+				FEPointCongruency::CONGRUENCY_DATA d = tool.Congruency(&mesh, sel[i]);
+				ke[i] = d.Ke;
+				progress.Increment();
+			}
+		}
+	});
+
+	// store the last state
+	if (bdone && (nstates > 0)) updateModel(nstates - 1, -1);
+
+	// restore the nodal positions
+	for (int i = 0; i < NN; ++i) mesh.Node(i).r = r0[i];
+
+	// don't leave a partially calculated field
+	if (bdone == false) fem.DeleteDataField(pdf);
+
+	doc->UpdateFEModel(true);
+	doc->UpdateObservers(true);
+
+	// this tool adds a data field to the model
+	// so we need to update the main toolbar
+	m_wnd->UpdateMainToolbar();
+}
@@ -46,6 +46,7 @@ public:
 
 private slots:
 	void OnApply();
+	void OnApplySelection();
 
 private:
 	CPointCongruencyToolUI*	ui;
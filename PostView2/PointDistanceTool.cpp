@@ -28,7 +28,10 @@ SOFTWARE.*/
 #include "PointDistanceTool.h"
 #include <GLLib/GDecoration.h>
 #include "Document.h"
+#include "MainWindow.h"
 #include <PostGL/GLModel.h>
+#include <PostLib/FEPostModel.h>
+#include <QRegExp>
 using namespace Post;
 
 class CPointDistanceDecoration : public GDecoration
@@ -76,6 +79,7 @@ CPointDistanceTool::Props::Props(CPointDistanceTool* ptool) : tool(ptool)
 	addProperty("Dz"     , CProperty::Float)->setFlags(CProperty::Visible);
 	addProperty("Length" , CProperty::Float)->setFlags(CProperty::Visible);
 	addProperty("Stretch", CProperty::Float)->setFlags(CProperty::Visible);
+	addProperty("more pairs", CProperty::String, "Additional node pairs for the time series, separated by semicolons, e.g. \"1,2; 5,8\"");
 }
 
 QVariant CPointDistanceTool::Props::GetPropertyValue(int i)
@@ -100,6 +104,7 @@ QVariant CPointDistanceTool::Props::GetPropertyValue(int i)
 			return s;
 		}
 		break;
+	case 7: return tool->m_pairs; break;
 	}
 	return QVariant();
 }
@@ -108,10 +113,11 @@ void CPointDistanceTool::Props::SetPropertyValue(int i, const QVariant& v)
 {
 	if (i==0) tool->m_node1 = v.toInt();
 	if (i==1) tool->m_node2 = v.toInt();
+	if (i==7) tool->m_pairs = v.toString();
 	tool->updateLength();
 }
 
-CPointDistanceTool::CPointDistanceTool(CMainWindow* wnd) : CBasicTool("Pt.Distance", wnd)
+CPointDistanceTool::CPointDistanceTool(CMainWindow* wnd) : CBasicTool("Pt.Distance", wnd, CBasicTool::HAS_APPLY_BUTTON)
 { 
 	m_node1 = 0; 
 	m_node2 = 0; 
@@ -213,3 +219,62 @@ void CPointDistanceTool::update(bool reset)
 
 	updateUi();
 }
+
+// Shows the length between node 1 and 2, and between any additional node pairs, as a function of
+// time. The positions of all nodes for all states are extracted in a single pass.
+void CPointDistanceTool::OnApply()
+{
+	CDocument* doc = GetActiveDocument();
+	if ((doc == nullptr) || (doc->IsValid() == false)) return;
+
+	Post::FEPostMesh& mesh = *doc->GetFEModel()->GetFEMesh(0);
+	int NN = mesh.Nodes();
+
+	// collect the (one-based) node pairs
+	vector<int> pairs;
+	if ((m_node1 > 0) && (m_node2 > 0) && (m_node1 <= NN) && (m_node2 <= NN))
+	{
+		pairs.push_back(m_node1);
+		pairs.push_back(m_node2);
+	}
+
+	QStringList pl = m_pairs.split(QRegExp("[;\\n]"), QString::SkipEmptyParts);
+	for (int i = 0; i < pl.size(); ++i)
+	{
+		QStringList ab = pl[i].split(QRegExp("[\\s,-]+"), QString::SkipEmptyParts);
+		if (ab.size() != 2) continue;
+
+		int a = ab[0].toInt();
+		int b = ab[1].toInt();
+		if ((a > 0) && (b > 0) && (a <= NN) && (b <= NN))
+		{
+			pairs.push_back(a);
+			pairs.push_back(b);
+		}
+	}
+	if (pairs.empty()) return;
+
+	// get the positions for all states
+	int N = (int)pairs.size();
+	vector<int> nodes(N);
+	for (int i = 0; i < N; ++i) nodes[i] = pairs[i] - 1;
+
+	vector<vec3f> r;
+	if (GetNodeHistory(nodes, r) == false) return;
+
+	int nstates = doc->GetFEModel()->GetStates();
+	int npairs = N / 2;
+	vector< vector<double> > data(npairs, vector<double>(nstates, 0.0));
+	QStringList labels;
+	for (int i = 0; i < npairs; ++i)
+	{
+		for (int n = 0; n < nstates; ++n)
+		{
+			vec3f d = r[n*N + 2*i + 1] - r[n*N + 2*i];
+			data[i][n] = d.Length();
+		}
+		labels << QString("Length (%1-%2)").arg(pairs[2*i]).arg(pairs[2*i + 1]);
+	}
+
+	m_wnd->ShowData(data, labels);
+}
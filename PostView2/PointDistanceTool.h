@@ -57,11 +57,15 @@ public:
 
 	void update(bool reset);
 
+	// evaluate the length for all states
+	void OnApply();
+
 private:
 	bool		m_bvalid;			// true of node1 and node2 defined
 	int			m_node1, m_node2;	// mesh nodes
 	vec3f		m_d0;				// initial separation vector
 	vec3f		m_d;				// separation vector
+	QString		m_pairs;			// additional node pairs for the time series
 	CPointDistanceDecoration*	m_deco;
 
 	friend class Props;
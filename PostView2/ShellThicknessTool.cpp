@@ -27,6 +27,7 @@ SOFTWARE.*/
 #include "StatePanel.h"
 #include "ShellThicknessTool.h"
 #include "Document.h"
+#include <PostGL/GLModel.h>
 #include <PostLib/FEPostModel.h>
 using namespace Post;
 
@@ -65,6 +66,8 @@ CPropertyList* CShellThicknessTool::getPropertyList()
 }
 
 //-----------------------------------------------------------------------------
+// Only the selected shells are visited. The thickness is still stored per state
+// since that is where the shell geometry reads it from.
 void CShellThicknessTool::OnApply()
 {
 	CDocument* doc = GetActiveDocument();
@@ -73,18 +76,30 @@ void CShellThicknessTool::OnApply()
 		FEPostModel& fem = *doc->GetFEModel();
 		Post::FEPostMesh& mesh = *fem.GetFEMesh(0);
 
+		// collect the selected shells
+		vector<int> sel;
+		doc->GetGLModel()->GetSelectionList(sel, SELECT_ELEMS);
+		vector<int> shells;
+		shells.reserve(sel.size());
+		for (int i = 0; i < (int)sel.size(); ++i)
+		{
+			int nel = sel[i];
+			if ((nel >= 0) && (nel < mesh.Elements()) && mesh.ElementRef(nel).IsShell()) shells.push_back(nel);
+		}
+		if (shells.empty()) { updateUi(); return; }
+
+		// The thickness is stored per state, so it is written to every state. Only the writes
+		// are limited to the selection: finding the selection and updating the model still
+		// process the whole mesh.
+		double h = m_h;
 		int NS = fem.GetStates();
-		for (int n=0; n<NS; ++n)
+		for (int n = 0; n < NS; ++n)
 		{
 			FEState& state = *fem.GetState(n);
-			for (int i=0; i<mesh.Elements(); ++i)
+			for (int i : shells)
 			{
-				FEElement_& elem = mesh.ElementRef(i);
-				if (elem.IsSelected() && elem.IsShell())
-				{
-					int ne = elem.Nodes();
-					for (int k=0; k<ne; ++k) state.m_ELEM[i].m_h[k] = m_h;
-				}
+				int ne = mesh.ElementRef(i).Nodes();
+				for (int k = 0; k<ne; ++k) state.m_ELEM[i].m_h[k] = h;
 			}
 		}
 		doc->UpdateFEModel(true);
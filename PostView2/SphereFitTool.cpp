@@ -35,12 +35,16 @@ SOFTWARE.*/
 #include "Document.h"
 #include <PostLib/FEPostModel.h>
 #include <MeshTools/SphereFit.h>
+#include "MainWindow.h"
+#include "BackgroundTask.h"
+#include "ParallelFor.h"
 using namespace Post;
 
 class CSphereFitToolUI : public QWidget
 {
 public:
 	QCheckBox*	pc;
+	QCheckBox*	pall;
 	QLineEdit*	x;
 	QLineEdit*	y;
 	QLineEdit*	z;
@@ -54,6 +58,7 @@ public:
 		QVBoxLayout* pv = new QVBoxLayout;
 		{
 			pc = new QCheckBox("Selection only");
+			pall = new QCheckBox("All time steps");
 			pb = new QPushButton("Fit");
 
 			QFormLayout* pf = new QFormLayout;
@@ -64,6 +69,7 @@ public:
 			pf->addRow("Obj.", O = new QLineEdit); O->setReadOnly(true);
 
 			pv->addWidget(pc);
+			pv->addWidget(pall);
 			pv->addWidget(pb);
 			pv->addLayout(pf);
 		}
@@ -107,6 +113,12 @@ void CSphereFitTool::OnFit()
 			}
 		}
 
+		if (ui->pall->isChecked())
+		{
+			FitAllStates();
+			return;
+		}
+
 		vector<vec3d> y;
 		for (int i=0; i<N; ++i)
 		{
@@ -134,3 +146,67 @@ void CSphereFitTool::OnFit()
 		ui->O->setText(QString("%1").arg(objs));
 	}
 }
+
+// Fits a sphere to the deformed coordinates of the tagged nodes for each state. The fits
+// are independent, so the states are fitted concurrently. The center and radius are shown
+// as a function of time in a graph window and the fit of the current state in the tool.
+// The nodes are taken from the first mesh, so states that use another mesh are not fitted.
+void CSphereFitTool::FitAllStates()
+{
+	CDocument* doc = GetActiveDocument();
+	FEPostModel& fem = *doc->GetFEModel();
+	Post::FEPostMesh& mesh = *fem.GetFEMesh(0);
+
+	vector<int> nodes;
+	for (int i=0; i<mesh.Nodes(); ++i)
+	{
+		if (mesh.Node(i).m_ntag == 1) nodes.push_back(i);
+	}
+	int NN = (int)nodes.size();
+
+	int nstates = fem.GetStates();
+	vector<double> xc(nstates, 0.0), yc(nstates, 0.0), zc(nstates, 0.0), Rc(nstates, 0.0), obj(nstates, 0.0);
+	CTaskProgress progress(nstates);
+	bool bdone = RunBackgroundTask(m_wnd, "Fitting spheres ...", progress, [&]() {
+		ParallelFor(nstates, [&](int n) {
+			if (progress.IsCancelled()) return;
+
+			FEState& state = *fem.GetState(n);
+			if (state.GetFEMesh() != &mesh)
+			{
+				xc[n] = yc[n] = zc[n] = Rc[n] = obj[n] = qQNaN();	// not plotted
+				progress.Increment();
+				return;
+			}
+
+			vector<vec3d> y(NN);
+			for (int i=0; i<NN; ++i)
+			{
+				vec3f r = state.m_NODE[nodes[i]].m_rt;
+				y[i] = vec3d(r.x, r.y, r.z);
+			}
+
+			SphereFit fit;
+			fit.Fit(y, 50);
+			xc[n] = fit.m_rc.x;
+			yc[n] = fit.m_rc.y;
+			zc[n] = fit.m_rc.z;
+			Rc[n] = fit.m_R;
+			obj[n] = fit.ObjFunc(y);
+
+			progress.Increment();
+		}, 1);
+	});
+	if (bdone == false) return;
+
+	// update GUI
+	int n = doc->GetGLModel()->CurrentTimeIndex();
+	ui->x->setText(QString("%1").arg(xc[n]));
+	ui->y->setText(QString("%1").arg(yc[n]));
+	ui->z->setText(QString("%1").arg(zc[n]));
+	ui->R->setText(QString("%1").arg(Rc[n]));
+	ui->O->setText(QString("%1").arg(obj[n]));
+
+	vector< vector<double> > data = { xc, yc, zc, Rc };
+	m_wnd->ShowData(data, QStringList() << "x" << "y" << "z" << "R");
+}
@@ -45,6 +45,9 @@ public:
 private slots:
 	void OnFit();
 
+private:
+	void FitAllStates();
+
 private:
 	CSphereFitToolUI*	ui;
 	friend class Props;
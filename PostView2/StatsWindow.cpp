@@ -30,19 +30,28 @@ SOFTWARE.*/
 #include "Document.h"
 #include "PlotWidget.h"
 #include "DataFieldSelector.h"
+#include "ParallelFor.h"
+#include "BackgroundTask.h"
 #include <QComboBox>
 #include <QToolBar>
 #include <QLabel>
 #include <QAction>
 #include <QCheckBox>
+#include <QLineEdit>
+#include <QValidator>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <PostLib/constants.h>
 #include <PostGL/GLDataMap.h>
 #include <PostGL/GLModel.h>
 #include <PostGL/GLPlaneCutPlot.h>
+#include <float.h>
 using namespace Post;
 
+// item flags
+#define ITEM_ENABLED	1
+#define ITEM_SELECTED	2
+
 CStatsWindow::CStatsWindow(CMainWindow* wnd) : CGraphWindow(wnd, 0)
 {
 	QString title = "PostView2: Statistics";
@@ -51,110 +60,379 @@ CStatsWindow::CStatsWindow(CMainWindow* wnd) : CGraphWindow(wnd, 0)
 	setWindowTitle(title);
 	setMinimumWidth(500);
 	resize(600, 500);
+
+	m_selectionOnly = new QCheckBox("Selection only");
+	m_allStates = new QCheckBox("All states");
+
+	m_binsEdit = new QLineEdit; m_binsEdit->setValidator(new QIntValidator(2, 100000)); m_binsEdit->setPlaceholderText("auto"); m_binsEdit->setMaximumWidth(60);
+	m_minEdit = new QLineEdit; m_minEdit->setValidator(new QDoubleValidator); m_minEdit->setPlaceholderText("auto"); m_minEdit->setMaximumWidth(80);
+	m_maxEdit = new QLineEdit; m_maxEdit->setValidator(new QDoubleValidator); m_maxEdit->setPlaceholderText("auto"); m_maxEdit->setMaximumWidth(80);
+
+	AddToolBarWidget(m_selectionOnly);
+	AddToolBarWidget(m_allStates);
+	AddToolBarWidget(new QLabel(" Bins: "));
+	AddToolBarWidget(m_binsEdit);
+	AddToolBarWidget(new QLabel(" Range: "));
+	AddToolBarWidget(m_minEdit);
+	AddToolBarWidget(m_maxEdit);
+
+	QObject::connect(m_selectionOnly, SIGNAL(stateChanged(int)), this, SLOT(onOptionsChanged()));
+	QObject::connect(m_allStates, SIGNAL(stateChanged(int)), this, SLOT(onOptionsChanged()));
+	QObject::connect(m_binsEdit, SIGNAL(editingFinished()), this, SLOT(onOptionsChanged()));
+	QObject::connect(m_minEdit, SIGNAL(editingFinished()), this, SLOT(onOptionsChanged()));
+	QObject::connect(m_maxEdit, SIGNAL(editingFinished()), this, SLOT(onOptionsChanged()));
+
+	m_bselectionOnly = false;
+	m_ballStates = false;
+	m_nbinsUser = 0;
+	m_buserRange = false;
+	m_userMin = m_userMax = 0.0;
+
+	m_bvalid = false;
+	m_nfield = -1;
+	m_nstate = -1;
+	m_belem = false;
+	m_minv = m_maxv = 0.0;
+
+	m_evalModel = 0;
+	m_evalRev = 0;
+	m_evalField = -1;
+}
+
+void CStatsWindow::onOptionsChanged()
+{
+	bool ballStates = m_allStates->isChecked();
+	int nbins = (m_binsEdit->text().isEmpty() ? 0 : m_binsEdit->text().toInt());
+	bool buserRange = (m_minEdit->text().isEmpty() == false) && (m_maxEdit->text().isEmpty() == false);
+	double umin = m_minEdit->text().toDouble();
+	double umax = m_maxEdit->text().toDouble();
+	if (umax < umin) { double tmp = umin; umin = umax; umax = tmp; }
+
+	bool bselectionOnly = m_selectionOnly->isChecked();
+
+	// changing the bins or the states requires a new histogram, and so does
+	// the selection option when the range is determined from the data
+	if ((ballStates != m_ballStates) || (nbins != m_nbinsUser) || (buserRange != m_buserRange) ||
+		(buserRange && ((umin != m_userMin) || (umax != m_userMax))) ||
+		((buserRange == false) && (bselectionOnly != m_bselectionOnly)))
+	{
+		m_bvalid = false;
+	}
+
+	m_ballStates = ballStates;
+	m_nbinsUser = nbins;
+	m_buserRange = buserRange;
+	m_userMin = umin;
+	m_userMax = umax;
+
+	// both counts are always kept, so with a user range this only changes what is shown
+	m_bselectionOnly = bselectionOnly;
+
+	Update(false);
 }
 
 void CStatsWindow::Update(bool breset, bool bfit)
 {
 	CDocument* doc = GetDocument();
-	if (doc->IsValid() == false) return;
+	if ((doc == nullptr) || (doc->IsValid() == false)) return;
 
-	Post::FEPostMesh* pm = doc->GetFEModel()->GetFEMesh(0);
-	int N, i, n;
+	int nfield = doc->GetEvalField();
+	int nstate = doc->currentTime();
 
-	bool belemfield = IS_ELEM_FIELD(doc->GetEvalField());
+	// see if we need to bin the data again or if the selection changed
+	if (breset || (m_bvalid == false) || (nfield != m_nfield) || ((m_ballStates == false) && (nstate != m_nstate)))
+	{
+		BuildHistogram();
+	}
+	else UpdateSelection(false);
+
+	ShowHistogram();
+}
+
+//-----------------------------------------------------------------------------
+void CStatsWindow::EvaluateItemFlags(std::vector<char>& flag)
+{
+	Post::FEPostMesh* pm = GetDocument()->GetFEModel()->GetFEMesh(0);
 
-	N = 0;
-	if (belemfield)
+	if (m_belem)
 	{
-		for (i=0; i<pm->Elements(); ++i) if (pm->ElementRef(i).IsEnabled()) ++N;
+		int NE = pm->Elements();
+		flag.resize(NE);
+		ParallelFor(NE, [&](int i) {
+			FEElement_& el = pm->ElementRef(i);
+			flag[i] = (el.IsEnabled() ? ITEM_ENABLED : 0) | (el.IsSelected() ? ITEM_SELECTED : 0);
+		});
 	}
 	else
 	{
-		for (i=0; i<pm->Nodes(); ++i) if (pm->Node(i).IsEnabled()) ++N;
+		int NN = pm->Nodes();
+		flag.resize(NN);
+		ParallelFor(NN, [&](int i) {
+			FENode& node = pm->Node(i);
+			flag[i] = (node.IsEnabled() ? ITEM_ENABLED : 0) | (node.IsSelected() ? ITEM_SELECTED : 0);
+		});
 	}
+}
+
+//-----------------------------------------------------------------------------
+// Bins the current field. The range is only searched when it is not known, so
+// this is a single pass over the values with a user range (or keepRange) and
+// two passes otherwise. The counts of all enabled items and of the selected
+// items are accumulated in the same pass.
+void CStatsWindow::BuildHistogram(bool keepRange)
+{
+	m_bvalid = false;
+	m_itemBin.clear();
+	m_binAll.clear();
+	m_binSel.clear();
+
+	CDocument* doc = GetDocument();
+	FEPostModel& fem = *doc->GetFEModel();
+	CGLModel* po = doc->GetGLModel();
 
-	int nbins = (int) sqrt((double)N);
+	m_nfield = doc->GetEvalField();
+	m_nstate = doc->currentTime();
+	m_belem = IS_ELEM_FIELD(m_nfield);
 
-	std::vector<int> bin(nbins, 0);
+	EvaluateItemFlags(m_itemFlag);
+	int N = (int)m_itemFlag.size();
 
-	FEState* ps = doc->GetGLModel()->GetActiveState();
-	double v, minv = 0, maxv = 0;
-	N = 0;
-	if (belemfield)
+	// the items that are shown (and that determine the range)
+	const char mask = (m_bselectionOnly ? (ITEM_ENABLED | ITEM_SELECTED) : ITEM_ENABLED);
+	int nitems = 0;
+	for (int i = 0; i < N; ++i) if ((m_itemFlag[i] & mask) == mask) nitems++;
+	if (nitems == 0) return;
+
+	// All states have to be evaluated for the current field. This can take a while, so it
+	// is done in the background, and only when the model data or the field changed since the
+	// last time. If the user cancels, the histogram falls back to the current state.
+	if (m_ballStates && ((m_evalModel != doc->GetModelID()) || (m_evalRev != doc->GetDataRevision()) || (m_evalField != m_nfield)))
 	{
-		for (i=0; i<pm->Elements(); ++i)
+		CTaskProgress progress;
+		bool bdone = RunBackgroundTask(this, "Evaluating all states ...", progress, [&]() {
+			doc->UpdateAllStates(&progress);
+		});
+
+		// the render model of the current state is not updated by UpdateAllStates
+		doc->UpdateFEModel();
+
+		if (bdone)
 		{
-			FEElement_& elem = pm->ElementRef(i);
-			if (elem.IsEnabled())
-			{
-				v = ps->m_ELEM[i].m_val;
-				if (N==0) minv = maxv = v;
-				if (v < minv) minv = v;
-				if (v > maxv) maxv = v;
-				++N;
-			}
+			m_evalModel = doc->GetModelID();
+			m_evalRev = doc->GetDataRevision();
+			m_evalField = m_nfield;
+		}
+		else
+		{
+			m_allStates->blockSignals(true);
+			m_allStates->setChecked(false);
+			m_allStates->blockSignals(false);
+			m_ballStates = false;
 		}
 	}
-	else
+
+	// collect the states we need to process
+	std::vector<FEState*> states;
+	if (m_ballStates)
 	{
-		for (i=0; i<pm->Nodes(); ++i)
-		{	
-			FENode& node = pm->Node(i);
-			if (node.IsEnabled())
-			{
-				v = ps->m_NODE[i].m_val;
-				if (N==0) minv = maxv = v;
-				if (v < minv) minv = v;
-				if (v > maxv) maxv = v;
-				++N;
-			}
-		}
+		int nsteps = fem.GetStates();
+		for (int i = 0; i < nsteps; ++i) states.push_back(fem.GetState(i));
 	}
+	else states.push_back(po->GetActiveState());
 
-	if (minv == maxv) ++maxv;
+	bool belem = m_belem;
+	auto value = [=](FEState* ps, int i) -> float { return (belem ? ps->m_ELEM[i].m_val : ps->m_NODE[i].m_val); };
 
-	if (belemfield)
+	// find the range
+	if (m_buserRange)
+	{
+		m_minv = m_userMin;
+		m_maxv = m_userMax;
+	}
+	else if (keepRange == false)
 	{
-		for (i=0; i<pm->Elements(); ++i)
+		// each block of items finds its own range, so threads don't share any data
+		const int BLOCK = 4096;
+		int nblocks = (N + BLOCK - 1) / BLOCK;
+		std::vector<float> bmin(nblocks, FLT_MAX), bmax(nblocks, -FLT_MAX);
+		for (FEState* ps : states)
+		{
+			ParallelFor(nblocks, [&](int b) {
+				float vmin = bmin[b], vmax = bmax[b];
+				int i1 = (b + 1)*BLOCK; if (i1 > N) i1 = N;
+				for (int i = b*BLOCK; i < i1; ++i)
+				{
+					if ((m_itemFlag[i] & mask) == mask)
+					{
+						float v = value(ps, i);
+						if (v < vmin) vmin = v;
+						if (v > vmax) vmax = v;
+					}
+				}
+				bmin[b] = vmin;
+				bmax[b] = vmax;
+			});
+		}
+
+		float vmin = FLT_MAX, vmax = -FLT_MAX;
+		for (int b = 0; b < nblocks; ++b)
 		{
-			FEElement_& elem = pm->ElementRef(i);
-			if (elem.IsEnabled())
+			if (bmin[b] < vmin) vmin = bmin[b];
+			if (bmax[b] > vmax) vmax = bmax[b];
+		}
+		m_minv = vmin;
+		m_maxv = vmax;
+	}
+	if (m_maxv <= m_minv) m_maxv = m_minv + 1.0;
+
+	int nbins = (m_nbinsUser > 0 ? m_nbinsUser : (int)sqrt((double)nitems));
+	if (nbins < 2) nbins = 2;
+
+	// bin the data
+	int nthreads = ParallelThreads();
+	std::vector< std::vector<int> > binAll(nthreads, std::vector<int>(nbins, 0));
+	std::vector< std::vector<int> > binSel(nthreads, std::vector<int>(nbins, 0));
+	if (m_ballStates == false) m_itemBin.assign(N, -1);
+
+	double minv = m_minv;
+	double scale = (nbins - 1) / (m_maxv - m_minv);
+	for (FEState* ps : states)
+	{
+		ParallelForThread(N, [&](int i, int t) {
+			int n = (int)((value(ps, i) - minv)*scale);
+			if ((n < 0) || (n >= nbins)) n = -1;
+
+			// the bin of every item is stored so that selection changes can be processed incrementally
+			if (m_ballStates == false) m_itemBin[i] = n;
+
+			char f = m_itemFlag[i];
+			if ((n >= 0) && (f & ITEM_ENABLED))
 			{
-				v = ps->m_ELEM[i].m_val;
-				n = (int) ((nbins-1)*((v - minv)/(maxv - minv)));
-				if ((n>=0) && (n<nbins)) bin[n]++;
+				binAll[t][n]++;
+				if (f & ITEM_SELECTED) binSel[t][n]++;
 			}
+		});
+	}
+
+	m_binAll.assign(nbins, 0);
+	m_binSel.assign(nbins, 0);
+	for (int t = 0; t < nthreads; ++t)
+	{
+		for (int n = 0; n < nbins; ++n)
+		{
+			m_binAll[n] += binAll[t][n];
+			m_binSel[n] += binSel[t][n];
 		}
 	}
-	else
+
+	m_bvalid = true;
+}
+
+//-----------------------------------------------------------------------------
+// Updates the selection counts. Only the items whose selection changed are
+// processed: for a single state with the stored bins, and for all states by
+// binning the values of those items in each state again.
+void CStatsWindow::UpdateSelection(bool breset)
+{
+	if (m_bvalid == false) return;
+
+	std::vector<char> flag;
+	EvaluateItemFlags(flag);
+	int N = (int)flag.size();
+	if (N != (int)m_itemFlag.size()) { BuildHistogram(); return; }
+
+	// find the items whose flags changed
+	int nthreads = ParallelThreads();
+	std::vector<int> enabledChanged(nthreads, 0);
+	std::vector< std::vector<int> > changed(nthreads);
+	ParallelForThread(N, [&](int i, int t) {
+		char f0 = m_itemFlag[i], f1 = flag[i];
+		if (f0 == f1) return;
+		if ((f0 ^ f1) & ITEM_ENABLED) { enabledChanged[t]++; return; }
+		changed[t].push_back(i);
+	});
+
+	int nenabled = 0;
+	std::vector<int> items;
+	for (int t = 0; t < nthreads; ++t)
+	{
+		nenabled += enabledChanged[t];
+		items.insert(items.end(), changed[t].begin(), changed[t].end());
+	}
+
+	// if the visible items changed, the bins are no longer valid
+	if (nenabled > 0) { BuildHistogram(); return; }
+	if (items.empty()) return;
+
+	// the range of the selection changed
+	if (m_bselectionOnly && (m_buserRange == false)) { BuildHistogram(); return; }
+
+	// the values of all states have to be the ones that were binned
+	CDocument* doc = GetDocument();
+	if (m_ballStates && ((m_evalModel != doc->GetModelID()) || (m_evalRev != doc->GetDataRevision())))
+	{
+		BuildHistogram();
+		return;
+	}
+
+	std::vector<FEState*> states;
+	if (m_ballStates)
 	{
-		for (i=0; i<pm->Nodes(); ++i)
+		FEPostModel& fem = *doc->GetFEModel();
+		int nsteps = fem.GetStates();
+		for (int i = 0; i < nsteps; ++i) states.push_back(fem.GetState(i));
+	}
+
+	int nbins = (int)m_binSel.size();
+	bool belem = m_belem;
+	double minv = m_minv;
+	double scale = (nbins - 1) / (m_maxv - m_minv);
+	std::vector< std::vector<int> > delta(nthreads, std::vector<int>(nbins, 0));
+	ParallelForThread((int)items.size(), [&](int k, int t) {
+		int i = items[k];
+		char f1 = flag[i];
+		if ((f1 & ITEM_ENABLED) == 0) return;
+		int d = (f1 & ITEM_SELECTED ? 1 : -1);
+
+		if (m_ballStates == false)
 		{
-			FENode& node = pm->Node(i);
-			if (node.IsEnabled())
+			int n = m_itemBin[i];
+			if (n >= 0) delta[t][n] += d;
+		}
+		else
+		{
+			for (FEState* ps : states)
 			{
-				v = ps->m_NODE[i].m_val;
-				n = (int) ((nbins-1)*((v - minv)/(maxv - minv)));
-				if ((n>=0) && (n<nbins)) bin[n]++;
+				float v = (belem ? ps->m_ELEM[i].m_val : ps->m_NODE[i].m_val);
+				int n = (int)((v - minv)*scale);
+				if ((n >= 0) && (n < nbins)) delta[t][n] += d;
 			}
 		}
-	}
+	});
+
+	for (int t = 0; t < nthreads; ++t)
+		for (int n = 0; n < nbins; ++n) m_binSel[n] += delta[t][n];
+
+	m_itemFlag.swap(flag);
+}
 
+//-----------------------------------------------------------------------------
+void CStatsWindow::ShowHistogram()
+{
 	ClearPlots();
-	
+
+	const std::vector<int>& bin = (m_bselectionOnly ? m_binSel : m_binAll);
 	if (bin.empty() == false)
 	{
 		CBarChartData* data = new CBarChartData;
 		data->setLabel("data");
 		for (int i=0; i<(int)bin.size(); ++i)
 		{
-			double x = minv + i*(maxv - minv)/(bin.size() - 1);
+			double x = m_minv + i*(m_maxv - m_minv)/(bin.size() - 1);
 			double y = bin[i];
 			data->addPoint(x, y);
 		}
 		AddPlotData(data);
-
-		UpdateSelection(true);
 	}
 
 	// redraw
@@ -163,8 +441,3 @@ void CStatsWindow::Update(bool breset, bool bfit)
 
 	UpdatePlots();
 }
-
-void CStatsWindow::UpdateSelection(bool breset)
-{
-
-}
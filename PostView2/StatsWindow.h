@@ -30,6 +30,8 @@ SOFTWARE.*/
 #include "GraphWindow.h"
 
 class CMainWindow;
+class QCheckBox;
+class QLineEdit;
 
 class CStatsWindow : public CGraphWindow
 {
@@ -41,5 +43,48 @@ public:
 	void Update(bool breset = true, bool bfit = false) override;
 
 private:
+	// rebuild the histogram (keepRange skips the min/max pass)
+	void BuildHistogram(bool keepRange = false);
+
+	// update the histogram counts after a selection change
 	void UpdateSelection(bool breset);
+
+	// get the enabled/selected flags of all items
+	void EvaluateItemFlags(std::vector<char>& flag);
+
+	// send the histogram to the plot widget
+	void ShowHistogram();
+
+private slots:
+	void onOptionsChanged();
+
+private:
+	QCheckBox*	m_selectionOnly;
+	QCheckBox*	m_allStates;
+	QLineEdit*	m_binsEdit;
+	QLineEdit*	m_minEdit;
+	QLineEdit*	m_maxEdit;
+
+	bool	m_bselectionOnly;	// only count selected items
+	bool	m_ballStates;		// aggregate over all states
+	int		m_nbinsUser;		// user number of bins (0 = auto)
+	bool	m_buserRange;		// use the user range
+	double	m_userMin, m_userMax;
+
+private: // cached histogram data
+	bool	m_bvalid;
+	int		m_nfield;		// field that was binned
+	int		m_nstate;		// state that was binned (when not aggregating)
+	bool	m_belem;		// element or node field
+	double	m_minv, m_maxv;	// range of the bins
+
+	// model, data revision and field for which all states were last evaluated
+	unsigned int	m_evalModel;
+	unsigned int	m_evalRev;
+	int				m_evalField;
+
+	std::vector<char>	m_itemFlag;	// enabled/selected flags of the items that were binned
+	std::vector<int>	m_itemBin;	// bin of each item (-1 if outside range); single state only
+	std::vector<int>	m_binAll;	// counts of all enabled items
+	std::vector<int>	m_binSel;	// counts of selected items
 };
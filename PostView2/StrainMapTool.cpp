@@ -32,6 +32,8 @@ SOFTWARE.*/
 #include <vector>
 #include "Document.h"
 #include <PostLib/FEStrainMap.h>
+#include "BackgroundTask.h"
+#include "MainWindow.h"
 using namespace std;
 using namespace Post;
 
@@ -142,8 +144,16 @@ void CStrainMapTool::OnApply()
 	CDocument* doc = GetActiveDocument();
 	if (doc && doc->IsValid())
 	{
+		// The map is calculated for all states, which can take a while, so run it in the
+		// background. It is a single call that cannot be interrupted, so the progress dialog
+		// has no Cancel button.
 		FEStrainMap& map = ui->m_map;
-		map.Apply(*doc->GetFEModel());
+		FEPostModel& fem = *doc->GetFEModel();
+		CTaskProgress progress;
+		progress.SetCancellable(false);
+		RunBackgroundTask(m_wnd, "Calculating strain map ...", progress, [&]() {
+			map.Apply(fem);
+		});
 		updateUi();
 	}
 }
@@ -97,9 +97,6 @@ void CSummaryWindow::Update(bool breset, bool bfit)
 	// see if selection only box is checked
 	bool bsel = m_bselectionOnly;
 
-	// see if volume average is checked
-	bool bvol = true; // ui->volumeAverage->isChecked();
-
 	// decide if we want to find the node/face/elem stat
 	int neval = -1;
 	if ((bsel && (nmode == SELECT_NODES)) || IS_NODE_FIELD(m_ncurrentData)) neval = 0;
@@ -114,10 +111,11 @@ void CSummaryWindow::Update(bool breset, bool bfit)
 	// get the number of time steps
 	int nsteps = doc->GetTimeSteps();
 
-	// allocate data
-	vector<double> x(nsteps);
-	// add the data series
-	for (int i=0; i<nsteps; i++) x[i] = pfem->GetState(i)->m_time;
+	// The ranges are cached by the document, so that changing the time step doesn't
+	// require evaluating all states again. The cache can't tell if the selection
+	// changed, so the ranges over the selection are evaluated again on each update.
+	CFieldStats& stats = doc->GetFieldStats();
+	if (bsel) stats.ClearSelection();
 
 	CLineChartData* dataMax = new CLineChartData;
 	CLineChartData* dataMin = new CLineChartData;
@@ -126,40 +124,18 @@ void CSummaryWindow::Update(bool breset, bool bfit)
 	dataAvg->setLabel("Avg");
 	dataMin->setLabel("Min");
 
-	// get the displacemet map
-	CGLDisplacementMap* pdm = po->GetDisplacementMap();
-
 	// loop over all time steps
 	for (int i=0; i<nsteps; i++)
 	{
 		// get the state
 		FEState* ps = pfem->GetState(i);
+		double x = ps->m_time;
 
-		// we need to make sure that the displacements are updated
-		// in case the user evaluates the strains
-		if (pdm) pdm->UpdateState(i);
+		FIELD_RANGE rng = stats.GetRange(*po, m_ncurrentData, i, neval, bsel);
 
-		// store the nodal values and field
-		int noldField = ps->m_nField;
-
-		// evaluate the mesh
-		pfem->Evaluate(m_ncurrentData, i);
- 
-		// store min/max values
-		RANGE rng;
-		switch (neval)
-		{
-		case 0: rng = EvalNodeRange(*pfem, i, bsel); break;
-		case 1: rng = EvalEdgeRange(*pfem, i, bsel); break;
-		case 2: rng = EvalFaceRange(*pfem, i, bsel, bvol); break;
-		case 3: rng = EvalElemRange(*pfem, i, bsel, bvol); break;
-		}
-		dataMax->addPoint(x[i], rng.fmax);
-		dataMin->addPoint(x[i], rng.fmin);
-		dataAvg->addPoint(x[i], rng.favg);
-		
-		// reset the field data
-		if (noldField >= 0) pfem->Evaluate(noldField, i);
+		dataMax->addPoint(x, rng.fmax);
+		dataMin->addPoint(x, rng.fmin);
+		dataAvg->addPoint(x, rng.favg);
 	}
 
 	// add the data
@@ -173,141 +149,3 @@ void CSummaryWindow::Update(bool breset, bool bfit)
 
 	UpdatePlots();
 }
-
-//-----------------------------------------------------------------------------
-// Evaluate the range of unpacked nodal data values
-CSummaryWindow::RANGE CSummaryWindow::EvalNodeRange(FEPostModel& fem, int nstate, bool bsel)
-{
-	RANGE rng = {-1e20f, 1e20f, 0.f};
-
-	FEState& state = *fem.GetState(nstate);
-	Post::FEPostMesh& mesh = *state.GetFEMesh();
-
-	float sum = 0;
-	
-	int NN = mesh.Nodes();
-	for (int i=0; i<NN; i++)
-	{
-		FENode& node = mesh.Node(i);
-		if ((bsel == false) || (node.IsSelected()))
-		{
-			float val = state.m_NODE[i].m_val;
-			rng.favg += val;
-			sum += 1.f;
-			if (val > rng.fmax) rng.fmax = val;
-			if (val < rng.fmin) rng.fmin = val;
-		}
-	}
-
-	if (sum == 0.f) rng.fmin = rng.fmax = 0.f;
-	else rng.favg /= sum;
-
-	return rng;
-}
-
-//-----------------------------------------------------------------------------
-// Evaluate the range of unpacked nodal data values
-CSummaryWindow::RANGE CSummaryWindow::EvalEdgeRange(FEPostModel& fem, int nstate, bool bsel)
-{
-	RANGE rng = {-1e20f, 1e20f, 0.f};
-
-	FEState& state = *fem.GetState(nstate);
-	Post::FEPostMesh& mesh = *state.GetFEMesh();
-
-	float sum = 0;
-	
-	int NE = mesh.Edges();
-	for (int i=0; i<NE; i++)
-	{
-		FEEdge& edge = mesh.Edge(i);
-		if ((bsel == false) || (edge.IsSelected()))
-		{
-			float val = state.m_EDGE[i].m_val;
-			rng.favg += val;
-			sum += 1.f;
-			if (val > rng.fmax) rng.fmax = val;
-			if (val < rng.fmin) rng.fmin = val;
-		}
-	}
-
-	if (sum == 0.f) rng.fmin = rng.fmax = 0.f;
-	else rng.favg /= sum;
-
-	return rng;
-}
-
-//-----------------------------------------------------------------------------
-// Evaluate the range of unpacked element data values
-CSummaryWindow::RANGE CSummaryWindow::EvalElemRange(FEPostModel& fem, int nstate, bool bsel, bool bvol)
-{
-	RANGE rng = {-1e20f, 1e20f, 0.f};
-
-	FEState& state = *fem.GetState(nstate);
-	Post::FEPostMesh& mesh = *state.GetFEMesh();
-
-	ValArray& elemData = state.m_ElemData;
-
-	float sum = 0.f;
-	int NE = mesh.Elements();
-	for (int i=0; i<NE; i++)
-	{
-		FEElement_& e = mesh.ElementRef(i);
-		int ne = e.Nodes();
-
-		if ((bsel == false) || (e.IsSelected()))
-		{
-			float w = 1;
-			if (bvol) w = mesh.ElementVolume(i);
-
-			for (int j=0; j<ne; ++j)
-			{
-//				float val = state.m_ELEM[i].m_val;
-				float val = elemData.value(i, j);
-
-				rng.favg += val*w;
-				sum += w;
-				if (val > rng.fmax) rng.fmax = val;
-				if (val < rng.fmin) rng.fmin = val;
-			}
-		}
-	}
-
-	if (sum == 0.f) rng.fmin = rng.fmax = 0.f;
-	else rng.favg /= sum;
-
-	return rng;
-}
-
-//-----------------------------------------------------------------------------
-// Evaluate the range of unpacked face data values
-CSummaryWindow::RANGE CSummaryWindow::EvalFaceRange(FEPostModel& fem, int nstate, bool bsel, bool bvol)
-{
-	RANGE rng = {-1e20f, 1e20f, 0.f};
-
-	FEState& state = *fem.GetState(nstate);
-	Post::FEPostMesh& mesh = *state.GetFEMesh();
-
-	float sum = 0.f;
-	int NF = mesh.Faces();
-	for (int i=0; i<NF; i++)
-	{
-		FEFace& f = mesh.Face(i);
-
-		if ((bsel == false) || (f.IsSelected()))
-		{
-			float val = state.m_FACE[i].m_val;
-			float w = 1;
-			if (bvol) w = mesh.FaceArea(f);
-
-			rng.favg += val*w;
-			sum += w;
-			if (val > rng.fmax) rng.fmax = val;
-			if (val < rng.fmin) rng.fmin = val;
-		}
-	}
-
-	if (sum == 0.f) rng.fmin = rng.fmax = 0.f;
-	else rng.favg /= sum;
-
-	return rng;
-}
@@ -0,0 +1,352 @@
+/*This file is part of the PostView source code and is licensed under the MIT license
+listed below.
+
+See Copyright-PostView.txt for details.
+
+Copyright (c) 2020 University of Utah, The Trustees of Columbia University in 
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#include "stdafx.h"
+#include "SurfaceMap.h"
+#include "SurfaceTree.h"
+#include "BackgroundTask.h"
+#include "ParallelFor.h"
+#include <PostLib/FEPostModel.h>
+#include <PostLib/FEMeshData_T.h>
+#include <PostLib/constants.h>
+#include <map>
+#include <math.h>
+#include <float.h>
+using namespace std;
+using namespace Post;
+
+//-----------------------------------------------------------------------------
+// For each state, a bounding volume hierarchy is built over surface 2, after which
+// the closest points of all nodes are found in parallel. When there are enough
+// states, the states themselves are processed in parallel instead, one batch of
+// states at a time. The sign is taken from the angle-weighted pseudo-normal of the
+// vertex, edge or face that contains the closest point, so that it is also correct
+// when the closest point lies on an edge or a corner of surface 2.
+bool CalculateDistanceMap(FEPostModel& fem, Post::FEPostMesh& mesh, int nfield, const vector<int>& sel1, const vector<int>& sel2, bool bsigned, CTaskProgress* progress)
+{
+	// collect the nodes of surface 1
+	vector<int> tag(mesh.Nodes(), 0);
+	vector<int> nodes;
+	for (int i : sel1)
+	{
+		FEFace& f = mesh.Face(i);
+		for (int j = 0; j < f.Nodes(); ++j)
+		{
+			if (tag[f.n[j]] == 0) { tag[f.n[j]] = 1; nodes.push_back(f.n[j]); }
+		}
+	}
+
+	// triangulate surface 2
+	vector<int> tri;
+	for (int i : sel2)
+	{
+		FEFace& f = mesh.Face(i);
+		int ntri;
+		const int* lt = FaceTriangulation(f.Nodes(), ntri);
+		for (int j = 0; j < 3 * ntri; ++j) tri.push_back(f.n[lt[j]]);
+	}
+	int NT = (int)tri.size() / 3;
+	int NN = (int)nodes.size();
+
+	// Number the vertices and edges of the triangulation. These are needed for the
+	// pseudo-normals. Edge k of a triangle connects its vertices k and (k+1)%3.
+	vector<int> tvert(3 * NT), tedge(3 * NT);
+	int NV = 0, NE = 0;
+	if (bsigned)
+	{
+		vector<int> vid(mesh.Nodes(), -1);
+		map<pair<int, int>, int> eid;
+		for (int i = 0; i < 3 * NT; ++i)
+		{
+			int n0 = tri[i];
+			int n1 = tri[3 * (i / 3) + (i + 1) % 3];
+			if (vid[n0] < 0) vid[n0] = NV++;
+			tvert[i] = vid[n0];
+
+			pair<int, int> e(min(n0, n1), max(n0, n1));
+			auto it = eid.find(e);
+			if (it == eid.end()) { eid[e] = NE; tedge[i] = NE++; }
+			else tedge[i] = it->second;
+		}
+	}
+
+	int ndata = FIELD_CODE(nfield);
+	int nstates = fem.GetStates();
+	if (progress) progress->SetTotal(nstates);
+
+	// calculates the distances of state n
+	auto evalState = [&](int n, vector<float>& dn, bool bparallel) {
+		dn.assign(NN, 0.f);
+		if (progress && progress->IsCancelled()) return;
+
+		vector<vec3f> pts(3 * NT);
+		for (int i = 0; i < 3 * NT; ++i) pts[i] = fem.NodePosition(tri[i], n);
+
+		CSurfaceTree tree;
+		tree.Build(pts);
+
+		// Calculate the pseudo-normals. The face normal is the triangle normal, the edge
+		// normal is the sum of the normals of the adjacent triangles, and the vertex
+		// normal is the sum of the normals of the triangles that share the vertex,
+		// weighted by the angle of the triangle at that vertex.
+		vector<vec3f> fn, en, vn;
+		if (bsigned)
+		{
+			fn.resize(NT);
+			en.assign(NE, vec3f(0.f, 0.f, 0.f));
+			vn.assign(NV, vec3f(0.f, 0.f, 0.f));
+			for (int i = 0; i < NT; ++i)
+			{
+				const vec3f* x = &pts[3 * i];
+				vec3f N = (x[1] - x[0]) ^ (x[2] - x[0]);
+				N.Normalize();
+				fn[i] = N;
+				for (int k = 0; k < 3; ++k)
+				{
+					vec3f a = x[(k + 1) % 3] - x[k]; a.Normalize();
+					vec3f b = x[(k + 2) % 3] - x[k]; b.Normalize();
+					float c = a*b;
+					if (c > 1.f) c = 1.f;
+					if (c < -1.f) c = -1.f;
+					vn[tvert[3 * i + k]] += N*acos(c);
+					en[tedge[3 * i + k]] += N;
+				}
+			}
+		}
+
+		auto evalNode = [&](int i) {
+			int inode = nodes[i];
+			vec3f r = fem.NodePosition(inode, n);
+			vec3f q;
+			int nf = TRI_FACE;
+			int t = tree.ClosestPoint(r, q, &nf);
+			float d = 0.f;
+			if (t >= 0)
+			{
+				d = (r - q).Length();
+				if (bsigned)
+				{
+					vec3f N;
+					switch (nf)
+					{
+					case TRI_VERTEX0: N = vn[tvert[3 * t    ]]; break;
+					case TRI_VERTEX1: N = vn[tvert[3 * t + 1]]; break;
+					case TRI_VERTEX2: N = vn[tvert[3 * t + 2]]; break;
+					case TRI_EDGE01 : N = en[tedge[3 * t    ]]; break;
+					case TRI_EDGE12 : N = en[tedge[3 * t + 1]]; break;
+					case TRI_EDGE20 : N = en[tedge[3 * t + 2]]; break;
+					default:
+						N = fn[t];
+					}
+					if ((r - q)*N < 0.f) d = -d;
+				}
+			}
+			dn[i] = d;
+		};
+
+		if (bparallel) ParallelFor(NN, evalNode);
+		else for (int i = 0; i < NN; ++i) evalNode(i);
+
+		if (progress) progress->Increment();
+	};
+
+	// copies the distances of state n to the data field
+	auto storeState = [&](int n, const vector<float>& dn) {
+		FEState* ps = fem.GetState(n);
+		FENodeData<float>& df = dynamic_cast<FENodeData<float>&>(ps->m_Data[ndata]);
+		for (int i = 0; i < NN; ++i) df[nodes[i]] = dn[i];
+	};
+
+	// The states of a batch are calculated in parallel, each into its own buffer,
+	// and then written to the field from this thread (see ParallelFor.h). A batch
+	// has one state per thread, so the buffers don't grow with the number of states.
+	int nthreads = ParallelThreads();
+	if (nstates >= nthreads)
+	{
+		vector< vector<float> > dist(nthreads);
+		for (int n0 = 0; n0 < nstates; n0 += nthreads)
+		{
+			int nb = (n0 + nthreads <= nstates ? nthreads : nstates - n0);
+			ParallelFor(nb, [&](int i) { evalState(n0 + i, dist[i], false); }, 1);
+			if (progress && progress->IsCancelled()) return false;
+			for (int i = 0; i < nb; ++i) storeState(n0 + i, dist[i]);
+		}
+	}
+	else
+	{
+		vector<float> dn;
+		for (int n = 0; n < nstates; ++n)
+		{
+			evalState(n, dn, true);
+			if (progress && progress->IsCancelled()) return false;
+			storeState(n, dn);
+		}
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// triangulate the faces and return the number of triangles of each face
+static void TriangulateFaces(Post::FEPostMesh& mesh, const vector<int>& sel, vector<int>& tri, vector<int>& ntri)
+{
+	for (int i : sel)
+	{
+		FEFace& f = mesh.Face(i);
+		int nt;
+		const int* lt = FaceTriangulation(f.Nodes(), nt);
+		for (int j = 0; j < 3 * nt; ++j) tri.push_back(f.n[lt[j]]);
+		ntri.push_back(nt);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// The node normals are the normalized sum of the normals of the faces of surface 1
+// that share the node. The rays are tested against a bounding volume hierarchy of
+// surface 2, which is rebuilt for each state. The states are processed in batches,
+// like the distance map.
+bool CalculateAreaCoverage(FEPostModel& fem, Post::FEPostMesh& mesh, int nfield, const vector<int>& sel1, const vector<int>& sel2, vector<double>& area, CTaskProgress* progress)
+{
+	// number the nodes of surface 1
+	vector<int> lid(mesh.Nodes(), -1);
+	vector<int> nodes;
+	int NF = (int)sel1.size();
+	vector<int> face0(NF + 1, 0), fnode;
+	for (int i = 0; i < NF; ++i)
+	{
+		FEFace& f = mesh.Face(sel1[i]);
+		for (int j = 0; j < f.Nodes(); ++j)
+		{
+			int nj = f.n[j];
+			if (lid[nj] < 0) { lid[nj] = (int)nodes.size(); nodes.push_back(nj); }
+			fnode.push_back(lid[nj]);
+		}
+		face0[i + 1] = (int)fnode.size();
+	}
+	int NN = (int)nodes.size();
+
+	// triangulate both surfaces
+	vector<int> tri1, ntri1, tri2, ntri2;
+	TriangulateFaces(mesh, sel1, tri1, ntri1);
+	TriangulateFaces(mesh, sel2, tri2, ntri2);
+
+	// offset of the first triangle of each face of surface 1
+	vector<int> tri0(NF + 1, 0);
+	for (int i = 0; i < NF; ++i) tri0[i + 1] = tri0[i] + ntri1[i];
+
+	int ndata = FIELD_CODE(nfield);
+	int nstates = fem.GetStates();
+	area.assign(nstates, 0.0);
+	if (progress) progress->SetTotal(nstates);
+
+	// calculates the coverage of the nodes of state n
+	auto evalState = [&](int n, vector<float>& covered, bool bparallel) {
+		covered.assign(NN, 0.f);
+		if (progress && progress->IsCancelled()) return;
+
+		vector<vec3f> pts(tri2.size());
+		for (int i = 0; i < (int)tri2.size(); ++i) pts[i] = fem.NodePosition(tri2[i], n);
+
+		CSurfaceTree tree;
+		tree.Build(pts);
+
+		// face areas and node normals
+		vector<float> faceArea(NF, 0.f);
+		vector<vec3f> nn(NN, vec3f(0.f, 0.f, 0.f));
+		for (int i = 0; i < NF; ++i)
+		{
+			vec3f N(0.f, 0.f, 0.f);
+			float A = 0.f;
+			for (int j = tri0[i]; j < tri0[i + 1]; ++j)
+			{
+				vec3f a = fem.NodePosition(tri1[3*j    ], n);
+				vec3f b = fem.NodePosition(tri1[3*j + 1], n);
+				vec3f c = fem.NodePosition(tri1[3*j + 2], n);
+				vec3f nj = (b - a) ^ (c - a);
+				A += 0.5f*nj.Length();
+				N += nj;
+			}
+			faceArea[i] = A;
+			N.Normalize();
+			for (int j = face0[i]; j < face0[i + 1]; ++j) nn[fnode[j]] += N;
+		}
+
+		auto evalNode = [&](int i) {
+			vec3f r = fem.NodePosition(nodes[i], n);
+			vec3f N = nn[i]; N.Normalize();
+			if (tree.IntersectSegment(r, N, 0.f, FLT_MAX)) covered[i] = 1.f;
+		};
+
+		if (bparallel) ParallelFor(NN, evalNode);
+		else for (int i = 0; i < NN; ++i) evalNode(i);
+
+		// the covered part of a face is the average of its nodal values
+		double sum = 0.0;
+		for (int i = 0; i < NF; ++i)
+		{
+			int nf = face0[i + 1] - face0[i];
+			if (nf == 0) continue;
+			float c = 0.f;
+			for (int j = face0[i]; j < face0[i + 1]; ++j) c += covered[fnode[j]];
+			sum += faceArea[i] * c / nf;
+		}
+		area[n] = sum;
+
+		if (progress) progress->Increment();
+	};
+
+	// copies the coverage of state n to the data field
+	auto storeState = [&](int n, const vector<float>& covered) {
+		FEState* ps = fem.GetState(n);
+		FENodeData<float>& df = dynamic_cast<FENodeData<float>&>(ps->m_Data[ndata]);
+		for (int i = 0; i < NN; ++i) df[nodes[i]] = covered[i];
+	};
+
+	int nthreads = ParallelThreads();
+	if (nstates >= nthreads)
+	{
+		vector< vector<float> > cov(nthreads);
+		for (int n0 = 0; n0 < nstates; n0 += nthreads)
+		{
+			int nb = (n0 + nthreads <= nstates ? nthreads : nstates - n0);
+			ParallelFor(nb, [&](int i) { evalState(n0 + i, cov[i], false); }, 1);
+			if (progress && progress->IsCancelled()) return false;
+			for (int i = 0; i < nb; ++i) storeState(n0 + i, cov[i]);
+		}
+	}
+	else
+	{
+		vector<float> covered;
+		for (int n = 0; n < nstates; ++n)
+		{
+			evalState(n, covered, true);
+			if (progress && progress->IsCancelled()) return false;
+			storeState(n, covered);
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,55 @@
+/*This file is part of the PostView source code and is licensed under the MIT license
+listed below.
+
+See Copyright-PostView.txt for details.
+
+Copyright (c) 2020 University of Utah, The Trustees of Columbia University in 
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#pragma once
+#include <vector>
+
+namespace Post {
+	class FEPostModel;
+	class FEPostMesh;
+}
+
+class CTaskProgress;
+
+//-----------------------------------------------------------------------------
+// Calculation kernels of the tools that map one surface onto another. They
+// don't depend on the UI, so that they can also be run outside of PostView
+// (see Benchmark/SurfaceMapBench.cpp). The surfaces are lists of face indices.
+
+// Calculates the distance of the nodes of surface 1 to surface 2 for all states
+// and stores it in the nodal data field nfield. If bsigned is true, the distance
+// is positive on the side that the normal of surface 2 points to. Returns false
+// if the calculation was cancelled, in which case some states may not have been
+// written yet.
+bool CalculateDistanceMap(Post::FEPostModel& fem, Post::FEPostMesh& mesh, int nfield, const std::vector<int>& sel1, const std::vector<int>& sel2, bool bsigned, CTaskProgress* progress = nullptr);
+
+// Calculates which nodes of surface 1 are covered by surface 2 for all states,
+// with the same definition as FEAreaCoverage: a node is covered if the ray from
+// the node along its normal hits surface 2. The result (1 if covered, 0 if not)
+// is stored in the nodal data field nfield. The covered area of each state, i.e.
+// the area of each face of surface 1 times the average value of its nodes, is
+// returned in area. Returns false if the calculation was cancelled.
+bool CalculateAreaCoverage(Post::FEPostModel& fem, Post::FEPostMesh& mesh, int nfield, const std::vector<int>& sel1, const std::vector<int>& sel2, std::vector<double>& area, CTaskProgress* progress = nullptr);
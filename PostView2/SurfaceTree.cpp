@@ -0,0 +1,353 @@
+/*This file is part of the PostView source code and is licensed under the MIT license
+listed below.
+
+See Copyright-PostView.txt for details.
+
+Copyright (c) 2020 University of Utah, The Trustees of Columbia University in 
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#include "stdafx.h"
+#include "SurfaceTree.h"
+#include <algorithm>
+#include <math.h>
+
+// max number of triangles in a leaf
+const int MAX_LEAF_SIZE = 4;
+
+//-----------------------------------------------------------------------------
+// squared distance of a point to a box (zero if the point is inside)
+static float BoxDistance2(const vec3f& p, const vec3f& rmin, const vec3f& rmax)
+{
+	float dx = (p.x < rmin.x ? rmin.x - p.x : (p.x > rmax.x ? p.x - rmax.x : 0.f));
+	float dy = (p.y < rmin.y ? rmin.y - p.y : (p.y > rmax.y ? p.y - rmax.y : 0.f));
+	float dz = (p.z < rmin.z ? rmin.z - p.z : (p.z > rmax.z ? p.z - rmax.z : 0.f));
+	return dx*dx + dy*dy + dz*dz;
+}
+
+//-----------------------------------------------------------------------------
+// Find the closest point on a triangle by checking in which Voronoi region of
+// the triangle the point lies (see Ericson, Real-Time Collision Detection).
+vec3f ClosestPointOnTriangle(const vec3f& p, const vec3f& a, const vec3f& b, const vec3f& c, int* feature)
+{
+	int tmp;
+	int& nf = (feature ? *feature : tmp);
+
+	vec3f ab = b - a;
+	vec3f ac = c - a;
+	vec3f ap = p - a;
+	float d1 = ab*ap;
+	float d2 = ac*ap;
+	if ((d1 <= 0.f) && (d2 <= 0.f)) { nf = TRI_VERTEX0; return a; }
+
+	vec3f bp = p - b;
+	float d3 = ab*bp;
+	float d4 = ac*bp;
+	if ((d3 >= 0.f) && (d4 <= d3)) { nf = TRI_VERTEX1; return b; }
+
+	float vc = d1*d4 - d3*d2;
+	if ((vc <= 0.f) && (d1 >= 0.f) && (d3 <= 0.f))
+	{
+		float v = d1 / (d1 - d3);
+		nf = TRI_EDGE01;
+		return a + ab*v;
+	}
+
+	vec3f cp = p - c;
+	float d5 = ab*cp;
+	float d6 = ac*cp;
+	if ((d6 >= 0.f) && (d5 <= d6)) { nf = TRI_VERTEX2; return c; }
+
+	float vb = d5*d2 - d1*d6;
+	if ((vb <= 0.f) && (d2 >= 0.f) && (d6 <= 0.f))
+	{
+		float w = d2 / (d2 - d6);
+		nf = TRI_EDGE20;
+		return a + ac*w;
+	}
+
+	float va = d3*d6 - d5*d4;
+	if ((va <= 0.f) && ((d4 - d3) >= 0.f) && ((d5 - d6) >= 0.f))
+	{
+		float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		nf = TRI_EDGE12;
+		return b + (c - b)*w;
+	}
+
+	float denom = 1.f / (va + vb + vc);
+	float v = vb*denom;
+	float w = vc*denom;
+	nf = TRI_FACE;
+	return a + ab*v + ac*w;
+}
+
+//-----------------------------------------------------------------------------
+// see if the segment r(t) = p + n*t, t0 <= t <= t1, crosses a box
+static bool SegmentIntersectsBox(const vec3f& p, const vec3f& n, float t0, float t1, const vec3f& rmin, const vec3f& rmax)
+{
+	const float eps = 1e-12f;
+	float tmin = t0, tmax = t1;
+	const float P[3] = { p.x, p.y, p.z };
+	const float N[3] = { n.x, n.y, n.z };
+	const float A[3] = { rmin.x, rmin.y, rmin.z };
+	const float B[3] = { rmax.x, rmax.y, rmax.z };
+	for (int i = 0; i < 3; ++i)
+	{
+		if (fabs(N[i]) < eps)
+		{
+			// the line is parallel to this slab
+			if ((P[i] < A[i]) || (P[i] > B[i])) return false;
+		}
+		else
+		{
+			float t1 = (A[i] - P[i]) / N[i];
+			float t2 = (B[i] - P[i]) / N[i];
+			if (t1 > t2) { float t = t1; t1 = t2; t2 = t; }
+			if (t1 > tmin) tmin = t1;
+			if (t2 < tmax) tmax = t2;
+			if (tmin > tmax) return false;
+		}
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Moller-Trumbore test, for both sides of the triangle and both directions of the line
+bool LineIntersectsTriangle(const vec3f& p, const vec3f& n, const vec3f& a, const vec3f& b, const vec3f& c, float* t)
+{
+	vec3f e1 = b - a;
+	vec3f e2 = c - a;
+	vec3f h = n ^ e2;
+	float det = e1*h;
+	if (fabs(det) < 1e-20f) return false;
+
+	float f = 1.f / det;
+	vec3f s = p - a;
+	float u = f*(s*h);
+	if ((u < 0.f) || (u > 1.f)) return false;
+
+	vec3f q = s ^ e1;
+	float v = f*(n*q);
+	if ((v < 0.f) || (u + v > 1.f)) return false;
+
+	if (t) *t = f*(e2*q);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Triangulations of the faces, using all the nodes of the face. The triangles
+// have the same orientation as the face.
+static const int TRI3[1][3] = { { 0, 1, 2 } };
+static const int QUAD4[2][3] = { { 0, 1, 2 }, { 0, 2, 3 } };
+static const int TRI6[4][3] = { { 0, 3, 5 }, { 3, 1, 4 }, { 5, 4, 2 }, { 3, 4, 5 } };
+static const int TRI7[6][3] = { { 0, 3, 6 }, { 3, 1, 6 }, { 1, 4, 6 }, { 4, 2, 6 }, { 2, 5, 6 }, { 5, 0, 6 } };
+static const int QUAD8[6][3] = { { 0, 4, 7 }, { 4, 1, 5 }, { 5, 2, 6 }, { 6, 3, 7 }, { 4, 5, 6 }, { 4, 6, 7 } };
+static const int QUAD9[8][3] = { { 0, 4, 8 }, { 0, 8, 7 }, { 4, 1, 5 }, { 4, 5, 8 }, { 8, 5, 2 }, { 8, 2, 6 }, { 7, 8, 6 }, { 7, 6, 3 } };
+
+const int* FaceTriangulation(int nodes, int& ntri)
+{
+	switch (nodes)
+	{
+	case 4: ntri = 2; return QUAD4[0];
+	case 6: ntri = 4; return TRI6[0];
+	case 7: ntri = 6; return TRI7[0];
+	case 8: ntri = 6; return QUAD8[0];
+	case 9: ntri = 8; return QUAD9[0];
+	}
+
+	// other faces are approximated by their corner nodes
+	ntri = 1;
+	return TRI3[0];
+}
+
+//=============================================================================
+CSurfaceTree::CSurfaceTree()
+{
+}
+
+//-----------------------------------------------------------------------------
+void CSurfaceTree::Build(const std::vector<vec3f>& pts)
+{
+	m_pt = pts;
+	m_node.clear();
+
+	int NT = Triangles();
+	m_tri.resize(NT);
+	for (int i = 0; i < NT; ++i) m_tri[i] = i;
+	if (NT == 0) return;
+
+	std::vector<vec3f> centroid(NT);
+	for (int i = 0; i < NT; ++i) centroid[i] = (pts[3*i] + pts[3*i + 1] + pts[3*i + 2]) / 3.f;
+
+	// the tree has at most 2*NT - 1 nodes
+	m_node.reserve(2*NT);
+	m_node.push_back(NODE());
+	BuildNode(0, 0, NT, centroid);
+
+	// reorder the points so that the triangles of each leaf are contiguous
+	for (int i = 0; i < NT; ++i)
+	{
+		int j = m_tri[i];
+		m_pt[3*i    ] = pts[3*j    ];
+		m_pt[3*i + 1] = pts[3*j + 1];
+		m_pt[3*i + 2] = pts[3*j + 2];
+	}
+}
+
+//-----------------------------------------------------------------------------
+void CSurfaceTree::BuildNode(int n, int first, int count, std::vector<vec3f>& centroid)
+{
+	// find the bounding box
+	vec3f rmin = m_pt[3*m_tri[first]], rmax = rmin;
+	vec3f cmin = centroid[m_tri[first]], cmax = cmin;
+	for (int i = first; i < first + count; ++i)
+	{
+		int t = m_tri[i];
+		for (int j = 0; j < 3; ++j)
+		{
+			const vec3f& r = m_pt[3*t + j];
+			if (r.x < rmin.x) rmin.x = r.x; if (r.x > rmax.x) rmax.x = r.x;
+			if (r.y < rmin.y) rmin.y = r.y; if (r.y > rmax.y) rmax.y = r.y;
+			if (r.z < rmin.z) rmin.z = r.z; if (r.z > rmax.z) rmax.z = r.z;
+		}
+
+		const vec3f& c = centroid[t];
+		if (c.x < cmin.x) cmin.x = c.x; if (c.x > cmax.x) cmax.x = c.x;
+		if (c.y < cmin.y) cmin.y = c.y; if (c.y > cmax.y) cmax.y = c.y;
+		if (c.z < cmin.z) cmin.z = c.z; if (c.z > cmax.z) cmax.z = c.z;
+	}
+	m_node[n].rmin = rmin;
+	m_node[n].rmax = rmax;
+
+	if (count <= MAX_LEAF_SIZE)
+	{
+		m_node[n].child = -1;
+		m_node[n].first = first;
+		m_node[n].count = count;
+		return;
+	}
+
+	// split at the median of the centroids along the longest axis
+	vec3f d = cmax - cmin;
+	int axis = (d.x >= d.y ? (d.x >= d.z ? 0 : 2) : (d.y >= d.z ? 1 : 2));
+	int half = count / 2;
+	std::nth_element(m_tri.begin() + first, m_tri.begin() + first + half, m_tri.begin() + first + count, [&](int a, int b) {
+		const vec3f& ca = centroid[a];
+		const vec3f& cb = centroid[b];
+		return (axis == 0 ? ca.x < cb.x : (axis == 1 ? ca.y < cb.y : ca.z < cb.z));
+	});
+
+	int child = (int)m_node.size();
+	m_node[n].child = child;
+	m_node[n].first = first;
+	m_node[n].count = 0;
+	m_node.push_back(NODE());
+	m_node.push_back(NODE());
+	BuildNode(child    , first       , half        , centroid);
+	BuildNode(child + 1, first + half, count - half, centroid);
+}
+
+//-----------------------------------------------------------------------------
+int CSurfaceTree::ClosestPoint(const vec3f& p, vec3f& q, int* feature) const
+{
+	if (m_node.empty()) return -1;
+
+	float dmin = 1e34f;
+	int imin = -1;
+
+	// depth-first traversal that visits the nearest child first and skips
+	// all nodes whose box is further away than the closest point so far
+	int stack[64];
+	int ns = 0;
+	stack[ns++] = 0;
+	while (ns > 0)
+	{
+		const NODE& node = m_node[stack[--ns]];
+		if (BoxDistance2(p, node.rmin, node.rmax) >= dmin) continue;
+
+		if (node.count > 0)
+		{
+			for (int i = node.first; i < node.first + node.count; ++i)
+			{
+				int nf;
+				vec3f r = ClosestPointOnTriangle(p, m_pt[3*i], m_pt[3*i + 1], m_pt[3*i + 2], &nf);
+				vec3f dr = r - p;
+				float d2 = dr*dr;
+				if (d2 < dmin)
+				{
+					dmin = d2;
+					imin = i;
+					q = r;
+					if (feature) *feature = nf;
+				}
+			}
+		}
+		else
+		{
+			const NODE& n0 = m_node[node.child];
+			const NODE& n1 = m_node[node.child + 1];
+			float d0 = BoxDistance2(p, n0.rmin, n0.rmax);
+			float d1 = BoxDistance2(p, n1.rmin, n1.rmax);
+			if (d0 <= d1)
+			{
+				stack[ns++] = node.child + 1;
+				stack[ns++] = node.child;
+			}
+			else
+			{
+				stack[ns++] = node.child;
+				stack[ns++] = node.child + 1;
+			}
+		}
+	}
+
+	return (imin >= 0 ? m_tri[imin] : -1);
+}
+
+//-----------------------------------------------------------------------------
+bool CSurfaceTree::IntersectSegment(const vec3f& p, const vec3f& n, float t0, float t1) const
+{
+	if (m_node.empty()) return false;
+
+	int stack[64];
+	int ns = 0;
+	stack[ns++] = 0;
+	while (ns > 0)
+	{
+		const NODE& node = m_node[stack[--ns]];
+		if (SegmentIntersectsBox(p, n, t0, t1, node.rmin, node.rmax) == false) continue;
+
+		if (node.count > 0)
+		{
+			for (int i = node.first; i < node.first + node.count; ++i)
+			{
+				float t;
+				if (LineIntersectsTriangle(p, n, m_pt[3*i], m_pt[3*i + 1], m_pt[3*i + 2], &t) && (t >= t0) && (t <= t1)) return true;
+			}
+		}
+		else
+		{
+			stack[ns++] = node.child;
+			stack[ns++] = node.child + 1;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,96 @@
+/*This file is part of the PostView source code and is licensed under the MIT license
+listed below.
+
+See Copyright-PostView.txt for details.
+
+Copyright (c) 2020 University of Utah, The Trustees of Columbia University in 
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#pragma once
+#include <MathLib/math3d.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// The part of a triangle that contains the closest point. The edges are numbered
+// by their first vertex, i.e. edge k connects vertex k and vertex (k+1)%3.
+enum TRIANGLE_FEATURE
+{
+	TRI_VERTEX0,
+	TRI_VERTEX1,
+	TRI_VERTEX2,
+	TRI_EDGE01,
+	TRI_EDGE12,
+	TRI_EDGE20,
+	TRI_FACE
+};
+
+//-----------------------------------------------------------------------------
+// Bounding volume hierarchy over a triangulated surface. It is used to find the
+// closest point on a surface in logarithmic instead of linear time. The tree
+// is read-only after it is built, so it can be queried from multiple threads.
+class CSurfaceTree
+{
+	struct NODE
+	{
+		vec3f	rmin, rmax;	// bounding box
+		int		child;		// index of first child (second child is child + 1)
+		int		first;		// first triangle of leaf
+		int		count;		// number of triangles of leaf (zero for interior nodes)
+	};
+
+public:
+	CSurfaceTree();
+
+	// build the tree from a list of triangles (three points per triangle)
+	void Build(const std::vector<vec3f>& pts);
+
+	// number of triangles in the tree
+	int Triangles() const { return (int)m_pt.size() / 3; }
+
+	// find the closest point on the surface. Returns the index of the
+	// triangle that contains the closest point, or -1 if the tree is empty.
+	// The optional feature returns the part of the triangle that contains the
+	// point (see TRIANGLE_FEATURE).
+	int ClosestPoint(const vec3f& p, vec3f& q, int* feature = nullptr) const;
+
+	// see if the segment p + n*t, with t0 <= t <= t1, intersects the surface
+	bool IntersectSegment(const vec3f& p, const vec3f& n, float t0, float t1) const;
+
+private:
+	void BuildNode(int n, int first, int count, std::vector<vec3f>& centroid);
+
+private:
+	std::vector<vec3f>	m_pt;	// triangle points, sorted so that leafs are contiguous
+	std::vector<int>	m_tri;	// original triangle index
+	std::vector<NODE>	m_node;	// tree nodes (root is m_node[0])
+};
+
+// closest point to p on the triangle (a, b, c)
+vec3f ClosestPointOnTriangle(const vec3f& p, const vec3f& a, const vec3f& b, const vec3f& c, int* feature = nullptr);
+
+// see if the line p + n*t intersects the triangle (a, b, c). The optional t
+// returns the line parameter of the intersection point.
+bool LineIntersectsTriangle(const vec3f& p, const vec3f& n, const vec3f& a, const vec3f& b, const vec3f& c, float* t = nullptr);
+
+// Returns the triangulation of a face with the given number of nodes as a list
+// of local node indices (three per triangle). All nodes of linear and quadratic
+// faces are used; other faces are approximated by their corner nodes.
+const int* FaceTriangulation(int nodes, int& ntri);
@@ -27,6 +27,9 @@ SOFTWARE.*/
 #include "Tool.h"
 #include "PropertyListForm.h"
 #include "MainWindow.h"
+#include "Document.h"
+#include "ParallelFor.h"
+#include <PostLib/FEPostModel.h>
 #include <QApplication>
 #include <QBoxLayout>
 #include <QPushButton>
@@ -50,6 +53,42 @@ CDocument* CAbstractTool::GetActiveDocument()
 	return m_wnd->GetActiveDocument();
 }
 
+//-----------------------------------------------------------------------------
+// The positions are read directly from the node data of each state. The states
+// are independent, so they are read in parallel. The node numbers refer to the
+// first mesh, so states that use another mesh get NaN positions.
+bool CAbstractTool::GetNodeHistory(const std::vector<int>& nodes, std::vector<vec3f>& r)
+{
+	CDocument* doc = GetActiveDocument();
+	if ((doc == nullptr) || (doc->IsValid() == false)) return false;
+
+	Post::FEPostModel& fem = *doc->GetFEModel();
+	Post::FEPostMesh* mesh = fem.GetFEMesh(0);
+	int N = (int)nodes.size();
+	for (int i = 0; i < N; ++i)
+	{
+		if ((nodes[i] < 0) || (nodes[i] >= mesh->Nodes())) return false;
+	}
+
+	int nstates = fem.GetStates();
+	r.resize(N*nstates);
+	ParallelFor(nstates, [&](int n) {
+		Post::FEState& state = *fem.GetState(n);
+		vec3f* rn = &r[n*N];
+		if (state.GetFEMesh() != mesh)
+		{
+			float nan = (float)qQNaN();
+			for (int i = 0; i < N; ++i) rn[i] = vec3f(nan, nan, nan);
+		}
+		else
+		{
+			for (int i = 0; i < N; ++i) rn[i] = state.m_NODE[nodes[i]].m_rt;
+		}
+	}, 1);
+
+	return true;
+}
+
 //-----------------------------------------------------------------------------
 void CToolUI::hideEvent(QHideEvent* ev)
 {
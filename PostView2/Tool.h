@@ -27,6 +27,7 @@ SOFTWARE.*/
 #pragma once
 #include "PropertyList.h"
 #include <QWidget>
+#include <vector>
 
 class CDocument;
 class CMainWindow;
@@ -68,6 +69,11 @@ public:
 	// get the active document
 	CDocument* GetActiveDocument();
 
+	// get the positions of the nodes (zero-based) for all states of the active document
+	// The position of node i at state n is stored in r[n*nodes.size() + i]. The nodes are
+	// numbered as in the first mesh; states that use another mesh get NaN positions.
+	bool GetNodeHistory(const std::vector<int>& nodes, std::vector<vec3f>& r);
+
 protected:
 	QString			m_name;
 	CMainWindow*	m_wnd;
@@ -36,6 +36,13 @@ CTransformTool::Props::Props(CTransformTool* ptool) : m_ptool(ptool)
 	addProperty("x-translation", CProperty::Float);
 	addProperty("y-translation", CProperty::Float);
 	addProperty("z-translation", CProperty::Float);
+	addProperty("x-rotation", CProperty::Float, "Rotation angle (degrees) about the x-axis");
+	addProperty("y-rotation", CProperty::Float, "Rotation angle (degrees) about the y-axis");
+	addProperty("z-rotation", CProperty::Float, "Rotation angle (degrees) about the z-axis");
+	addProperty("x-scale", CProperty::Float);
+	addProperty("y-scale", CProperty::Float);
+	addProperty("z-scale", CProperty::Float);
+	addProperty("", CProperty::Action, "Undo last transform");
 }
 
 //-----------------------------------------------------------------------------
@@ -46,6 +53,12 @@ QVariant CTransformTool::Props::GetPropertyValue(int i)
 	case 0: return m_ptool->m_dr.x; break;
 	case 1: return m_ptool->m_dr.y; break;
 	case 2: return m_ptool->m_dr.z; break;
+	case 3: return m_ptool->m_rot.x; break;
+	case 4: return m_ptool->m_rot.y; break;
+	case 5: return m_ptool->m_rot.z; break;
+	case 6: return m_ptool->m_scl.x; break;
+	case 7: return m_ptool->m_scl.y; break;
+	case 8: return m_ptool->m_scl.z; break;
 	}
 	return QVariant();
 }
@@ -58,13 +71,23 @@ void CTransformTool::Props::SetPropertyValue(int i, const QVariant& v)
 	case 0: m_ptool->m_dr.x = v.toFloat(); break;
 	case 1: m_ptool->m_dr.y = v.toFloat(); break;
 	case 2: m_ptool->m_dr.z = v.toFloat(); break;
+	case 3: m_ptool->m_rot.x = v.toFloat(); break;
+	case 4: m_ptool->m_rot.y = v.toFloat(); break;
+	case 5: m_ptool->m_rot.z = v.toFloat(); break;
+	case 6: m_ptool->m_scl.x = v.toFloat(); break;
+	case 7: m_ptool->m_scl.y = v.toFloat(); break;
+	case 8: m_ptool->m_scl.z = v.toFloat(); break;
+	case 9: m_ptool->OnUndo(); break;
 	}
 }
 
 //-----------------------------------------------------------------------------
 CTransformTool::CTransformTool(CMainWindow* wnd) : CBasicTool("Transform", wnd, CBasicTool::HAS_APPLY_BUTTON)
 {
-	m_dr = vec3f(0.f, 0.f, 0.f);
+	m_dr  = vec3f(0.f, 0.f, 0.f);
+	m_rot = vec3f(0.f, 0.f, 0.f);
+	m_scl = vec3f(1.f, 1.f, 1.f);
+	m_undoModel = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -74,18 +97,120 @@ CPropertyList* CTransformTool::getPropertyList()
 }
 
 //-----------------------------------------------------------------------------
+// Applies x' = c + R*S*(x - c) + t to the selected nodes, where c is the center
+// of the selection. The positions are copied to separate coordinate arrays so
+// that the transformation is a simple loop the compiler can vectorize.
 void CTransformTool::OnApply()
 {
 	CDocument* doc = GetActiveDocument();
 	if (doc && doc->IsValid())
 	{
-		const vector<FENode*> selNodes = doc->GetGLModel()->GetNodeSelection();
-		for (int i=0; i<(int)selNodes.size(); ++i)
+		Post::FEPostMesh& mesh = *doc->GetActiveMesh();
+
+		// get the (zero-based) indices of the selected nodes
+		vector<int> nodes;
+		doc->GetGLModel()->GetSelectionList(nodes, SELECT_NODES);
+		int N = (int)nodes.size();
+		if (N == 0) { updateUi(); return; }
+
+		// gather the positions
+		vector<float> x(N), y(N), z(N);
+		vec3f c(0.f, 0.f, 0.f);
+		m_undoPos.resize(N);
+		for (int i=0; i<N; ++i)
+		{
+			vec3f r = mesh.Node(nodes[i]).r;
+			m_undoPos[i] = r;
+			x[i] = r.x; y[i] = r.y; z[i] = r.z;
+			c += r;
+		}
+		c /= (float) N;
+		m_undoNodes = nodes;
+		m_undoModel = doc->GetModelID();
+
+		// a pure translation doesn't need the matrix
+		bool bidentity = (m_rot.x == 0.f) && (m_rot.y == 0.f) && (m_rot.z == 0.f) && (m_scl.x == 1.f) && (m_scl.y == 1.f) && (m_scl.z == 1.f);
+		if (bidentity)
+		{
+			for (int i=0; i<N; ++i) mesh.Node(nodes[i]).r += m_dr;
+			doc->UpdateFEModel(true);
+			updateUi();
+			return;
+		}
+
+		// setup the rotation matrix R = Rz*Ry*Rx
+		double ax = m_rot.x*PI/180.0, ay = m_rot.y*PI/180.0, az = m_rot.z*PI/180.0;
+		double cx = cos(ax), sx = sin(ax);
+		double cy = cos(ay), sy = sin(ay);
+		double cz = cos(az), sz = sin(az);
+		double R[3][3] = {
+			{ cz*cy, cz*sy*sx - sz*cx, cz*sy*cx + sz*sx },
+			{ sz*cy, sz*sy*sx + cz*cx, sz*sy*cx - cz*sx },
+			{   -sy,            cy*sx,            cy*cx }
+		};
+
+		// A = R*S
+		float s[3] = { m_scl.x, m_scl.y, m_scl.z };
+		float A[3][3];
+		for (int i=0; i<3; ++i)
+			for (int j=0; j<3; ++j) A[i][j] = (float)(R[i][j]*s[j]);
+
+		// b = c + t - A*c, so that x' = A*x + b
+		vec3f b;
+		b.x = c.x + m_dr.x - (A[0][0]*c.x + A[0][1]*c.y + A[0][2]*c.z);
+		b.y = c.y + m_dr.y - (A[1][0]*c.x + A[1][1]*c.y + A[1][2]*c.z);
+		b.z = c.z + m_dr.z - (A[2][0]*c.x + A[2][1]*c.y + A[2][2]*c.z);
+
+		// transform
+		float* px = &x[0];
+		float* py = &y[0];
+		float* pz = &z[0];
+		for (int i=0; i<N; ++i)
 		{
-			FENode& node = *selNodes[i];
-			node.r += m_dr;
+			float xi = px[i], yi = py[i], zi = pz[i];
+			px[i] = A[0][0]*xi + A[0][1]*yi + A[0][2]*zi + b.x;
+			py[i] = A[1][0]*xi + A[1][1]*yi + A[1][2]*zi + b.y;
+			pz[i] = A[2][0]*xi + A[2][1]*yi + A[2][2]*zi + b.z;
 		}
+
+		// scatter the new positions
+		for (int i=0; i<N; ++i) mesh.Node(nodes[i]).r = vec3f(x[i], y[i], z[i]);
+
 		doc->UpdateFEModel(true);
 	}
 	updateUi();
 }
+
+//-----------------------------------------------------------------------------
+// Restores the nodes that were moved by the last transformation.
+void CTransformTool::OnUndo()
+{
+	CDocument* doc = GetActiveDocument();
+	if (doc && doc->IsValid() && (doc->GetModelID() == m_undoModel) && (m_undoNodes.empty() == false))
+	{
+		Post::FEPostMesh& mesh = *doc->GetActiveMesh();
+		int NN = mesh.Nodes();
+		for (int i=0; i<(int)m_undoNodes.size(); ++i)
+		{
+			int n = m_undoNodes[i];
+			if (n < NN) mesh.Node(n).r = m_undoPos[i];
+		}
+		doc->UpdateFEModel(true);
+	}
+	clearUndo();
+}
+
+//-----------------------------------------------------------------------------
+void CTransformTool::update(bool breset)
+{
+	// a new model was loaded
+	if (breset) clearUndo();
+}
+
+//-----------------------------------------------------------------------------
+void CTransformTool::clearUndo()
+{
+	m_undoNodes.clear();
+	m_undoPos.clear();
+	m_undoModel = 0;
+}
@@ -54,8 +54,24 @@ public:
 	// Apply button
 	void OnApply();
 
+	// undo the last transformation
+	void OnUndo();
+
+	// update (a reset clears the undo data)
+	void update(bool breset) override;
+
 private:
-	vec3f	m_dr;
+	void clearUndo();
+
+private:
+	vec3f	m_dr;		// translation
+	vec3f	m_rot;		// rotation angles (degrees), applied in x, y, z order
+	vec3f	m_scl;		// scale factors
+
+	// data needed to undo the last transformation
+	unsigned int		m_undoModel;	// ID of the model (see CDocument::GetModelID)
+	std::vector<int>	m_undoNodes;	// (zero-based) indices of the transformed nodes
+	std::vector<vec3f>	m_undoPos;		// original positions of these nodes
 
 	friend class Props;
 };
@@ -22,8 +22,8 @@ QT_BEGIN_MOC_NAMESPACE
 QT_WARNING_PUSH
 QT_WARNING_DISABLE_DEPRECATED
 struct qt_meta_stringdata_CStatsWindow_t {
-    QByteArrayData data[1];
-    char stringdata0[13];
+    QByteArrayData data[3];
+    char stringdata0[31];
 };
 #define QT_MOC_LITERAL(idx, ofs, len) \
     Q_STATIC_BYTE_ARRAY_DATA_HEADER_INITIALIZER_WITH_OFFSET(len, \
@@ -32,10 +32,12 @@ struct qt_meta_stringdata_CStatsWindow_t {
     )
 static const qt_meta_stringdata_CStatsWindow_t qt_meta_stringdata_CStatsWindow = {
     {
-QT_MOC_LITERAL(0, 0, 12) // "CStatsWindow"
+QT_MOC_LITERAL(0, 0, 12), // "CStatsWindow"
+QT_MOC_LITERAL(1, 13, 16), // "onOptionsChanged"
+QT_MOC_LITERAL(2, 30, 0) // ""
 
     },
-    "CStatsWindow"
+    "CStatsWindow\0onOptionsChanged\0"
 };
 #undef QT_MOC_LITERAL
 
@@ -45,21 +47,32 @@ static const uint qt_meta_data_CStatsWindow[] = {
        8,       // revision
        0,       // classname
        0,    0, // classinfo
-       0,    0, // methods
+       1,   14, // methods
        0,    0, // properties
        0,    0, // enums/sets
        0,    0, // constructors
        0,       // flags
        0,       // signalCount
 
+ // slots: name, argc, parameters, tag, flags
+       1,    0,   19,    2, 0x08 /* Private */,
+
+ // slots: parameters
+    QMetaType::Void,
+
        0        // eod
 };
 
 void CStatsWindow::qt_static_metacall(QObject *_o, QMetaObject::Call _c, int _id, void **_a)
 {
-    Q_UNUSED(_o);
-    Q_UNUSED(_id);
-    Q_UNUSED(_c);
+    if (_c == QMetaObject::InvokeMetaMethod) {
+        auto *_t = static_cast<CStatsWindow *>(_o);
+        Q_UNUSED(_t)
+        switch (_id) {
+        case 0: _t->onOptionsChanged(); break;
+        default: ;
+        }
+    }
     Q_UNUSED(_a);
 }
 
@@ -89,6 +102,17 @@ void *CStatsWindow::qt_metacast(const char *_clname)
 int CStatsWindow::qt_metacall(QMetaObject::Call _c, int _id, void **_a)
 {
     _id = CGraphWindow::qt_metacall(_c, _id, _a);
+    if (_id < 0)
+        return _id;
+    if (_c == QMetaObject::InvokeMetaMethod) {
+        if (_id < 1)
+            qt_static_metacall(this, _c, _id, _a);
+        _id -= 1;
+    } else if (_c == QMetaObject::RegisterMethodArgumentMetaType) {
+        if (_id < 1)
+            *reinterpret_cast<int*>(_a[0]) = -1;
+        _id -= 1;
+    }
     return _id;
 }
 QT_WARNING_POP